@@ -24,161 +24,203 @@
  */
 
 #include "actors.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <deque>
 #include <iostream>
+#include <stdexcept>
 #include <libplayerc++/playerc++.h>
+#ifdef __SSE2__
+#include <xmmintrin.h>
+#endif
 
 namespace jlbot {
 
-  Vector::Vector() : coordinates_(0, 0) {
-  }
-
-  Vector::Vector(Radians direction, double magnitude) {
-    double x = ComputeX(direction, magnitude);
-    double y = ComputeY(direction, magnitude);
-    coordinates_ = WorldCoordinates(x, y);
-  }
-
-  Vector::Vector(WorldCoordinates coordindates) {
-    coordinates_ = coordindates;
-  }
-
-  double Vector::ComputeX(Radians direction, double magnitude) {
-    double radians = direction.ToDouble();
-    return magnitude * std::cos(radians);
-  }
-
-  double Vector::ComputeY(Radians direction, double magnitude) {
-    double radians = direction.ToDouble();
-    return magnitude * std::sin(radians);
-  }
-
-  Radians Vector::ComputeDirection(WorldCoordinates coordinates) {
-    return Radians(WorldCoordinates::kOrigin, coordinates);
-  }
-
-  double Vector::ComputeMagnitude(WorldCoordinates coordinates) {
-    return coordinates.Distance(WorldCoordinates::kOrigin);
-  }
-
-  Radians Vector::GetDirection() {
-    return ComputeDirection(coordinates_);
-  }
-
-  double Vector::GetMagnitude() {
-    return ComputeMagnitude(coordinates_);
-  }
-
-  Vector Vector::Normalize(double magnitude) {
-    return Vector(GetDirection(), magnitude);
-  }
-
-  Vector Vector::Magnify(double factor) {
-    Radians direction = GetDirection();
-    double magnitude = GetMagnitude() * factor;
-    return Vector(direction, magnitude);
-  }
-
-  Vector Vector::Add(Vector other) {
-    WorldCoordinates sum = coordinates_.Add(other.coordinates_);
-    return Vector(sum);
-  }
-
-  double ObstacleField::GetMagnitude(double distance) {
-    double preferred_distance = 0.3;
-    return distance < preferred_distance ? 1 : 0;
-  }
-
-  Vector ObstacleField::GetVector(double distance, Radians direction) {
-    Radians flipped_direction = direction.Flip();
-    double magnitude = GetMagnitude(distance);
-    return Vector(flipped_direction, magnitude);
-  }
-
-  WaypointField::WaypointField() {
-  }
-
-  WaypointField::WaypointField(WorldCoordinates waypoint) {
-    waypoint_ = waypoint;
-  }
-
-  Vector WaypointField::GetVector(WorldCoordinates current_position) {
-    double magnitude = 1;
-    Radians direction(current_position, waypoint_);
-    return Vector(direction, magnitude);
-  }
-
-  double WaypointField::GetDistance(WorldCoordinates current_position) {
-    return current_position.Distance(waypoint_);
-  }
-
-  bool WaypointField::AtWaypoint(WorldCoordinates current_position) {
-    double distance_from_waypoint = GetDistance(current_position);
-    return distance_from_waypoint < 0.4;
-  }
-
-  Act::Act(Robot *robot, Sense *sensors) {
-    robot_ = robot;
-    sense_ = sensors;
-  }
-
-  void Act::GoTo(WorldCoordinates waypoint) {
-    std::cout << "Going to waypoint " << waypoint.ToString() << "...." << std::endl;
-    waypoint_field_ = WaypointField(waypoint);
-    robot_->Read();
-    while (!waypoint_field_.AtWaypoint(sense_->GetCurrentPosition())) {
-      Vector final_field = GetCombinedVector();
-      Radians desired_direction = final_field.GetDirection();
-      Radians current_direction = robot_->Facing();
-      double turn_rate = current_direction.Difference(desired_direction);
-      double max_turn_rate = M_PI / 3;
-      double turn_speed = PlayerCc::limit(std::abs(turn_rate), 0.0, max_turn_rate);
-      double longitudinal_speed = 4 * std::pow(max_turn_rate - turn_speed, 2);
-      longitudinal_speed = PlayerCc::limit(longitudinal_speed, 0.0, 4.0);
-      robot_->Move(longitudinal_speed, turn_rate);
-      robot_->Read();
+  constexpr double ObstacleField::kDefaultGain;
+  constexpr double ObstacleField::kDefaultFalloff;
+  constexpr double Act::kAlongTrackGain;
+  constexpr double Act::kCrossTrackGain;
+  constexpr double Act::kHeadingGain;
+  constexpr double Act::kMinTrackingSpeed;
+  constexpr double Act::kArrivalDistance;
+  constexpr double Act::kStopDistance;
+  constexpr double Act::kStopHalfAngle;
+  constexpr double Act::kGapClearance;
+
+  /* A falloff that is not positive would divide by zero, so it is refused along with a negative or infinite gain */
+  ObstacleField::ObstacleField(double gain, double falloff) : gain_(gain), falloff_(falloff), beam_count_(0), min_angle_(0), resolution_(0) {
+    if (!(falloff > 0) || !std::isfinite(falloff)) {
+      throw std::invalid_argument("Repulsion falloff must be a positive distance.");
+    }
+    if (!(gain >= 0) || !std::isfinite(gain)) {
+      throw std::invalid_argument("Repulsion gain must be zero or positive.");
     }
-    std::cout << "Reached waypoint." << std::endl;
   }
 
-  Vector Act::GetAttractionVector() {
-    WorldCoordinates current_location = sense_->GetCurrentPosition();
-    return waypoint_field_.GetVector(current_location);
+  /* Tables padded with zeros to whole blocks, so padding beams push nowhere */
+  void ObstacleField::BuildTables(const LaserScan &scan) {
+    beam_count_ = scan.ranges.size();
+    min_angle_ = scan.min_angle;
+    resolution_ = scan.resolution;
+    std::size_t blocks = (beam_count_ + FloatBlock::kLanes - 1) / FloatBlock::kLanes;
+    cosines_.assign(blocks, FloatBlock());
+    sines_.assign(blocks, FloatBlock());
+    FillDirections(Angle::FromRadians(min_angle_), resolution_, beam_count_, cosines_[0].values, sines_[0].values);
   }
 
-  Vector Act::AvoidObstaclesGroup(double magnitude, double degrees1, double degrees2, double degrees3) {
-    std::deque<Degrees> degrees = {Degrees(degrees1), Degrees(degrees2), Degrees(degrees3)};
-    Vector combined;
-    for (Degrees i : degrees) {
-      Radians j = i.ToRadians();
-      Vector temp = ObstacleField::GetVector(sense_->GetRange(j), j);
-      combined.Add(temp);
+  /* Summed in the robot's frame, returned in the world frame like the waypoint's pull */
+  Vec2 ObstacleField::GetVector(Sense *sensors) {
+    const LaserScan &scan = sensors->GetScan();
+    if (sensors->GetBeamCount() == 0) {
+      return Vec2();
+    }
+    if (sensors->GetBeamCount() != beam_count_ || scan.min_angle != min_angle_ || scan.resolution != resolution_) {
+      BuildTables(scan);
     }
-    if (combined.GetMagnitude() >= 1) {
-      combined = combined.Normalize(magnitude);
+    const float *ranges = sensors->GetRanges();
+    const float *cosines = cosines_[0].values;
+    const float *sines = sines_[0].values;
+    int count = cosines_.size() * FloatBlock::kLanes;
+    float inverse_falloff = 1 / falloff_;
+    float x = 0;
+    float y = 0;
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 one = _mm_set1_ps(1);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(inverse_falloff);
+    __m128 sum_x = zero;
+    __m128 sum_y = zero;
+    for (; i < count; i += FloatBlock::kLanes) {
+      __m128 closeness = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_load_ps(ranges + i), scale)));
+      __m128 weight = _mm_mul_ps(closeness, closeness);
+      sum_x = _mm_add_ps(sum_x, _mm_mul_ps(weight, _mm_load_ps(cosines + i)));
+      sum_y = _mm_add_ps(sum_y, _mm_mul_ps(weight, _mm_load_ps(sines + i)));
     }
-    return combined;
+    float lanes[FloatBlock::kLanes];
+    _mm_storeu_ps(lanes, sum_x);
+    x = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_storeu_ps(lanes, sum_y);
+    y = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < count; i++) {
+      float closeness = std::max(0.0f, 1 - ranges[i] * inverse_falloff);
+      x += closeness * closeness * cosines[i];
+      y += closeness * closeness * sines[i];
+    }
+    return sensors->GetFacing().Rotate(Vec2(x, y) * (-gain_ * resolution_));
   }
 
-  Vector Act::AvoidFrontObstacles() {
-    return AvoidObstaclesGroup(1, 0, -10, 10);
+  Act::Act(SensorFeed *feed, Sense *sensors, double control_rate, ObstacleField obstacle_field, OccupancyMapper *mapper) : control_(control_rate), obstacle_field_(obstacle_field) {
+    feed_ = feed;
+    sense_ = sensors;
+    mapper_ = mapper;
+    mapped_sequence_ = 0;
+    speed_ = 0;
   }
 
-  Vector Act::AvoidLeftObstacles() {
-    return AvoidObstaclesGroup(1, -45, -60, -89);
+  /* Last commanded forward speed, so a replanned trajectory can start at it */
+  double Act::GetSpeed() {
+    return speed_;
   }
 
-  Vector Act::AvoidRightObstacles() {
-    return AvoidObstaclesGroup(1, 45, 60, 89);
+  /* Commands a stop, so the robot does not keep its last speed while the caller plans */
+  void Act::Stop() {
+    speed_ = 0;
+    feed_->Command(0, 0);
   }
 
-  Vector Act::GetCombinedVector() {
-    Vector combined;
-    combined = combined.Add(GetAttractionVector());
-    combined = combined.Add(AvoidFrontObstacles());
-    combined = combined.Add(AvoidRightObstacles());
-    combined = combined.Add(AvoidLeftObstacles());
-    return combined;
+  /*
+   * Refreshes the readings for this cycle and fuses the scan into the map
+   * if it is new; the loop runs faster than the laser, so most cycles see
+   * the same scan again. Returns false once the map has changed.
+   */
+  bool Act::Observe() {
+    sense_->Refresh();
+    if (mapper_ == NULL || sense_->GetSequence() == mapped_sequence_) {
+      return true;
+    }
+    mapped_sequence_ = sense_->GetSequence();
+    mapper_->Integrate(sense_->GetScan());
+    if (mapper_->HasChanges()) {
+      std::cout << "Map changed." << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  /*
+   * True if the robot should turn left to get around what blocks it: the
+   * left has the wider gap of beams that see past kGapClearance, or, with
+   * gaps alike, the closest obstacle ahead is on the right.
+   */
+  bool Act::IsLeftOpener() {
+    double left_gap = sense_->GetWidestGap(Angle::FromRadians(0), Angle::FromRadians(kPi / 2), kGapClearance);
+    double right_gap = sense_->GetWidestGap(Angle::FromRadians(-kPi / 2), Angle::FromRadians(0), kGapClearance);
+    if (left_gap != right_gap) {
+      return left_gap > right_gap;
+    }
+    int closest = sense_->GetClosestBeam(Angle::FromRadians(-kStopHalfAngle), Angle::FromRadians(kStopHalfAngle));
+    return closest < 0 || sense_->GetBeamDirection(closest).ToRadians() < 0;
+  }
+
+  /*
+   * Tracks the trajectory against the clock, starting from the setpoint
+   * nearest the robot. The setpoint's speed and yaw rate are fed forward
+   * and the position and heading errors, taken in the robot's frame, are
+   * fed back (Kanayama et al., "A Stable Tracking Control Method for an
+   * Autonomous Mobile Robot"). Obstacles the map does not know about yet
+   * are handled reactively: the obstacle field is added to the reference
+   * heading, steering it away from them, and the part of the field that
+   * pushes against the robot's heading takes off speed. Anything closer
+   * than the stop distance in front stops the robot, which then turns in
+   * place toward the more open side until the way ahead is clear. Returns false as soon as the map changes, and true
+   * once the robot is near the end after its time.
+   */
+  bool Act::Follow(Trajectory *trajectory) {
+    std::cout << "Following trajectory...." << std::endl;
+    sense_->Refresh();
+    double offset = trajectory->GetNearestTime(sense_->GetCurrentPosition());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool arrived = false;
+    control_.Run([&]() {
+      if (!Observe()) {
+        return false;
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      double time = offset + elapsed.count();
+      Setpoint setpoint = trajectory->GetSetpoint(time);
+      WorldCoordinates position = sense_->GetCurrentPosition();
+      if (time >= trajectory->GetDuration() && position.Distance(setpoint.position) < kArrivalDistance) {
+        arrived = true;
+        return false;
+      }
+      Angle facing = sense_->GetFacing();
+      Vec2 heading = facing.ToVec2();
+      Vec2 error = setpoint.position.ToVec2() - position.ToVec2();
+      double along_error = heading.Dot(error);
+      double cross_error = heading.Cross(error);
+      Vec2 push = obstacle_field_.GetVector(sense_);
+      Vec2 reference = Angle::FromRadians(setpoint.heading).ToVec2() + push;
+      double heading_error = reference.LengthSquared() > 0 ? facing.Difference(Angle::Of(reference)) : 0;
+      double braking = std::min(std::max(-push.Dot(heading), 0.0), 1.0);
+      double tracking_speed = std::max(setpoint.speed, kMinTrackingSpeed);
+      double longitudinal_speed = (setpoint.speed * std::cos(heading_error) + kAlongTrackGain * along_error) * (1 - braking);
+      double turn_rate = setpoint.yaw_rate + tracking_speed * (kCrossTrackGain * cross_error + kHeadingGain * std::sin(heading_error));
+      speed_ = PlayerCc::limit(longitudinal_speed, 0.0, Trajectory::kMaxSpeed);
+      if (sense_->GetMinRange(Angle::FromRadians(-kStopHalfAngle), Angle::FromRadians(kStopHalfAngle)) < kStopDistance) {
+        speed_ = 0;
+        turn_rate = IsLeftOpener() ? Trajectory::kMaxYawRate : -Trajectory::kMaxYawRate;
+      }
+      feed_->Command(speed_, PlayerCc::limit(turn_rate, -Trajectory::kMaxYawRate, Trajectory::kMaxYawRate));
+      return true;
+    });
+    std::cout << control_.ToString() << std::endl;
+    if (!arrived) {
+      return false;
+    }
+    Stop();
+    std::cout << "Reached the end of the trajectory." << std::endl;
+    return true;
   }
 } // namespace jlbot
\ No newline at end of file
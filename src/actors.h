@@ -26,61 +26,72 @@
 #ifndef ACTORS_H
 #define ACTORS_H
 
+#include <vector>
+#include "controlloop.h"
+#include "geometry.h"
 #include "misc.h"
+#include "occupancymapper.h"
+#include "sensorfeed.h"
 #include "sensors.h"
+#include "trajectory.h"
 
 namespace jlbot {
 
-  class Vector {
-  public:
-    Vector();
-    Vector(Radians direction, double magnitude);
-    Radians GetDirection();
-    double GetMagnitude();
-    Vector Normalize(double magnitude);
-    Vector Magnify(double factor);
-    Vector Add(Vector other);
-  private:
-    WorldCoordinates coordinates_;
-    static double ComputeX(Radians direction, double magnitude);
-    static double ComputeY(Radians direction, double magnitude);
-    static Radians ComputeDirection(WorldCoordinates coordinates);
-    static double ComputeMagnitude(WorldCoordinates coordinates);
-    Vector(WorldCoordinates coordindates);
-  };
-
+  /*
+   * Repulsion summed over every beam of the scan. A beam that sees an
+   * obstacle at range d pushes away along its direction with weight
+   * (1 - d / falloff)^2, so the push grows smoothly from nothing at the
+   * falloff distance to full at contact. The sum is scaled by gain and by
+   * the angle between beams, so it does not depend on the laser's
+   * resolution. Cosines and sines of the beam directions are kept in
+   * aligned tables beside the ranges and the sum is one SSE2 pass.
+   */
   class ObstacleField {
   public:
-    static Vector GetVector(double distance, Radians direction);
-  private:
-    static double GetMagnitude(double distance);
-  };
-
-  class WaypointField {
-  public:
-    WaypointField();
-    WaypointField(WorldCoordinates waypoint);
-    Vector GetVector(WorldCoordinates current_position);
-    bool AtWaypoint(WorldCoordinates current_position);
+    static constexpr double kDefaultGain = 2;
+    static constexpr double kDefaultFalloff = 1;
+    ObstacleField(double gain = kDefaultGain, double falloff = kDefaultFalloff);
+    Vec2 GetVector(Sense *sensors);
   private:
-    WorldCoordinates waypoint_;
-    double GetDistance(WorldCoordinates current_position);
+    double gain_;
+    double falloff_;
+    int beam_count_;
+    double min_angle_;
+    double resolution_;
+    std::vector<FloatBlock> cosines_;
+    std::vector<FloatBlock> sines_;
+    void BuildTables(const LaserScan &scan);
   };
 
+  /*
+   * Drives the robot from a ControlLoop on the calling thread. Readings
+   * come from the feed's snapshots through sensors and commands go back
+   * through the feed, so Act never touches Player itself.
+   */
   class Act {
   public:
-    Act(Robot *robot, Sense *sensors);
-    void GoTo(WorldCoordinates waypoint);
+    Act(SensorFeed *feed, Sense *sensors, double control_rate, ObstacleField obstacle_field, OccupancyMapper *mapper = NULL);
+    bool Follow(Trajectory *trajectory);
+    void Stop();
+    double GetSpeed();
   private:
-    Robot *robot_;
+    static constexpr double kAlongTrackGain = 1;
+    static constexpr double kCrossTrackGain = 2;
+    static constexpr double kHeadingGain = 2;
+    static constexpr double kMinTrackingSpeed = 0.3;
+    static constexpr double kArrivalDistance = 0.4;
+    static constexpr double kStopDistance = 0.35;
+    static constexpr double kStopHalfAngle = kPi / 6;
+    static constexpr double kGapClearance = 1;
+    SensorFeed *feed_;
     Sense *sense_;
-    WaypointField waypoint_field_;
-    Vector GetAttractionVector();
-    Vector AvoidObstaclesGroup(double magnitude, double degrees1, double degrees2, double degrees3);
-    Vector AvoidFrontObstacles();
-    Vector AvoidLeftObstacles();
-    Vector AvoidRightObstacles();
-    Vector GetCombinedVector();
+    OccupancyMapper *mapper_;
+    ControlLoop control_;
+    unsigned long mapped_sequence_;
+    double speed_;
+    ObstacleField obstacle_field_;
+    bool Observe();
+    bool IsLeftOpener();
   };
 } // namespace jlbot
 #endif /* ACTORS_H */
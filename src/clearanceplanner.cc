@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   clearanceplanner.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 26, 2017, 2:15 PM
+ */
+
+#include "clearanceplanner.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace jlbot {
+
+  const int ClearancePlanner::kUnreached;
+
+  std::string ClearancePlanner::GetName() {
+    return "clearance weighted Dijkstra";
+  }
+
+  float ClearancePlanner::GetComfortClearance() {
+    return kComfortClearance;
+  }
+
+  /*
+   * Step costs never exceed kMaxStepCost, so every queued cell lies within
+   * kMaxStepCost of the bucket being drained and kMaxStepCost + 1 buckets
+   * used round robin hold them all. A cell is queued again each time its
+   * cost drops; entries whose cost no longer matches the bucket are stale.
+   */
+  std::deque<ModelCoordinates> ClearancePlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    grid_.Reset(model);
+    ComputePenalties(model);
+    int source = grid_.Index(start);
+    int target = grid_.Index(goal);
+    std::deque<ModelCoordinates> path;
+    if (grid_.IsBlocked(source)) {
+      return path;
+    }
+    /* Like the wavefront, the goal cell may be entered even if it holds an obstacle */
+    grid_.SetBlocked(target, false);
+    int step_costs[8];
+    for (int direction = 0; direction < 8; direction++) {
+      step_costs[direction] = grid_.GetCost(direction) > 1 ? kDiagonalCost : kStraightCost;
+    }
+    costs_.assign(grid_.GetSize(), kUnreached);
+    parents_.resize(grid_.GetSize());
+    buckets_.resize(kMaxStepCost + 1);
+    for (std::vector<int> &bucket : buckets_) {
+      bucket.clear();
+    }
+    costs_[source] = 0;
+    parents_[source] = source;
+    buckets_[0].push_back(source);
+    int queued = 1;
+    int expanded = 0;
+    for (int cost = 0; queued > 0 && (costs_[target] == kUnreached || cost < costs_[target]); cost++) {
+      std::vector<int> &bucket = buckets_[cost % buckets_.size()];
+      for (std::size_t i = 0; i < bucket.size(); i++) {
+        int cell = bucket[i];
+        queued--;
+        if (costs_[cell] != cost) {
+          continue;
+        }
+        expanded++;
+        for (int direction = 0; direction < 8; direction++) {
+          int neighbor = cell + grid_.GetOffset(direction);
+          if (grid_.IsBlocked(neighbor)) {
+            continue;
+          }
+          int next = cost + step_costs[direction] + penalties_[neighbor];
+          if (costs_[neighbor] == kUnreached || next < costs_[neighbor]) {
+            costs_[neighbor] = next;
+            parents_[neighbor] = cell;
+            buckets_[next % buckets_.size()].push_back(neighbor);
+            queued++;
+          }
+        }
+      }
+      bucket.clear();
+    }
+    std::cout << "Clearance weighted Dijkstra expanded " << expanded << " cells." << std::endl;
+    if (costs_[target] == kUnreached) {
+      return path;
+    }
+    for (int cell = target; cell != source; cell = parents_[cell]) {
+      path.push_front(grid_.ToCoordinates(cell));
+    }
+    path.push_front(start);
+    return path;
+  }
+
+  /* Penalty of entering each padded grid cell, zero where clearance is unknown */
+  void ClearancePlanner::ComputePenalties(WorldModel *model) {
+    penalties_.assign(grid_.GetSize(), 0);
+    const float *clearances = model->GetClearances();
+    if (clearances == NULL) {
+      return;
+    }
+    int width = model->GetWidth();
+    int height = model->GetHeight();
+    for (int y = 0; y < height; y++) {
+      const float *row = clearances + static_cast<std::size_t>(y) * width;
+      unsigned char *penalties = &penalties_[grid_.Index(ModelCoordinates(0, y))];
+      for (int x = 0; x < width; x++) {
+        float shortfall = kComfortClearance - std::min(row[x], static_cast<float>(kComfortClearance));
+        penalties[x] = static_cast<unsigned char>(std::lround(kPenaltyPerCell * shortfall));
+      }
+    }
+  }
+} // namespace jlbot
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   clearanceplanner.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 26, 2017, 2:15 PM
+ */
+
+#ifndef CLEARANCEPLANNER_H
+#define CLEARANCEPLANNER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "searchplanners.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Dijkstra over small integer step costs, kept in a circular bucket queue
+   * (Dial's algorithm) so each cell costs about as much as in a breadth
+   * first wave. Entering a cell costs its step length plus a penalty that
+   * grows as the cell's clearance drops below kComfortClearance, so paths
+   * keep to the middle of corridors and doorways instead of hugging the
+   * grown obstacles. Clearance comes from the map as loaded; obstacles the
+   * mapper adds later block cells but add no penalty around them.
+   */
+  class ClearancePlanner : public Planner {
+  public:
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+    float GetComfortClearance();
+  private:
+    static const int kStraightCost = 5;
+    static const int kDiagonalCost = 7;
+    static const int kPenaltyPerCell = 2;
+    static const int kComfortClearance = 12;
+    static const int kMaxStepCost = kDiagonalCost + kPenaltyPerCell * kComfortClearance;
+    static const int kUnreached = -1;
+    SearchGrid grid_;
+    std::vector<unsigned char> penalties_;
+    std::vector<int> costs_;
+    std::vector<int> parents_;
+    std::vector<std::vector<int> > buckets_;
+    void ComputePenalties(WorldModel *model);
+  };
+} // namespace jlbot
+#endif /* CLEARANCEPLANNER_H */
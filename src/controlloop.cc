@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   controlloop.cc
+ * Author: Johnathan Louie
+ *
+ * Created on May 3, 2017, 11:20 AM
+ */
+
+#include "controlloop.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace jlbot {
+
+  /* A rate that is not positive and finite, or whose period the clock cannot hold, is refused */
+  ControlLoop::ControlLoop(double rate) : rate_(rate), total_latency_(0) {
+    if (!(rate > 0) || !std::isfinite(rate)) {
+      throw std::invalid_argument("Control rate must be a positive number of hertz.");
+    }
+    std::chrono::duration<double> period(1 / rate);
+    if (period >= std::chrono::steady_clock::duration::max()) {
+      throw std::invalid_argument("Control rate is too low for the clock.");
+    }
+    period_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    if (period_.count() <= 0) {
+      throw std::invalid_argument("Control rate is too high for the clock.");
+    }
+    stats_ = ControlStats{0, 0, 0, 0, 0};
+  }
+
+  /* Calls cycle once per period until it returns false */
+  void ControlLoop::Run(std::function<bool()> cycle) {
+    std::chrono::steady_clock::time_point release = std::chrono::steady_clock::now();
+    bool running = true;
+    while (running) {
+      std::this_thread::sleep_until(release);
+      std::chrono::steady_clock::time_point wake = std::chrono::steady_clock::now();
+      running = cycle();
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      double jitter = std::chrono::duration<double>(wake - release).count();
+      double latency = std::chrono::duration<double>(end - release).count();
+      stats_.cycles++;
+      total_latency_ += latency;
+      stats_.mean_latency = total_latency_ / stats_.cycles;
+      stats_.max_latency = std::max(stats_.max_latency, latency);
+      stats_.max_jitter = std::max(stats_.max_jitter, jitter);
+      release += period_;
+      if (end > release) {
+        stats_.misses++;
+        release += (end - release) / period_ * period_ + period_;
+      }
+    }
+  }
+
+  /* Counts accumulate over every Run */
+  std::string ControlLoop::ToString() {
+    std::ostringstream text;
+    text << "Control loop at " << rate_ << " Hz: " << stats_.cycles << " cycles, " << stats_.misses << " deadline misses, latency mean "
+        << stats_.mean_latency * 1000 << " ms max " << stats_.max_latency * 1000 << " ms, wake-up jitter max " << stats_.max_jitter * 1000 << " ms.";
+    return text.str();
+  }
+} // namespace jlbot
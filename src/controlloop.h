@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   controlloop.h
+ * Author: Johnathan Louie
+ *
+ * Created on May 3, 2017, 11:20 AM
+ */
+
+#ifndef CONTROLLOOP_H
+#define CONTROLLOOP_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace jlbot {
+
+  /* Times are in seconds; latency runs from a cycle's release time to its end */
+  struct ControlStats {
+    unsigned long cycles;
+    unsigned long misses;
+    double mean_latency;
+    double max_latency;
+    double max_jitter;
+  };
+
+  /*
+   * Runs a cycle at a fixed rate on the calling thread, which becomes the
+   * control thread. Each cycle is released at an absolute deadline rather
+   * than a sleep after the last one, so the period does not drift with the
+   * cycle's own time. A cycle that ends past the next release is a miss;
+   * the releases it overran are skipped rather than run back to back.
+   */
+  class ControlLoop {
+  public:
+    ControlLoop(double rate);
+    void Run(std::function<bool()> cycle);
+    std::string ToString();
+  private:
+    std::chrono::steady_clock::duration period_;
+    double rate_;
+    ControlStats stats_;
+    double total_latency_;
+  };
+} // namespace jlbot
+#endif /* CONTROLLOOP_H */
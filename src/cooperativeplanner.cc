@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   cooperativeplanner.cc
+ * Author: Johnathan Louie
+ *
+ * Created on May 1, 2017, 11:25 AM
+ */
+
+#include "cooperativeplanner.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <tuple>
+#include <unordered_set>
+
+namespace jlbot {
+
+  const int ReservationTable::kFree;
+
+  ReservationTable::ReservationTable(int width, int height, int footprint) : width_(width), height_(height), footprint_(footprint) {
+  }
+
+  void ReservationTable::Clear() {
+    owners_.clear();
+    parked_.clear();
+    last_visits_.clear();
+  }
+
+  /* Reserves the footprint at every step of the path and parks the robot at its end */
+  void ReservationTable::Reserve(int robot, const std::deque<ModelCoordinates> &path) {
+    for (std::size_t time = 0; time < path.size(); time++) {
+      ModelCoordinates center = path[time];
+      bool last = time + 1 == path.size();
+      for (int y = std::max(center.GetY() - footprint_, 0); y <= std::min(center.GetY() + footprint_, height_ - 1); y++) {
+        for (int x = std::max(center.GetX() - footprint_, 0); x <= std::min(center.GetX() + footprint_, width_ - 1); x++) {
+          int cell = Index(x, y);
+          owners_[Key(cell, time)] = robot;
+          std::pair<int, int> &last_visit = last_visits_[cell];
+          if (static_cast<int>(time) >= last_visit.first) {
+            last_visit = std::make_pair(static_cast<int>(time), robot);
+          }
+          if (last) {
+            parked_[cell] = std::make_pair(robot, static_cast<int>(time));
+          }
+        }
+      }
+    }
+  }
+
+  /* The robot in cell at time, or kFree */
+  int ReservationTable::GetOwner(ModelCoordinates cell, int time) {
+    int index = Index(cell.GetX(), cell.GetY());
+    std::unordered_map<std::uint64_t, int>::iterator owner = owners_.find(Key(index, time));
+    if (owner != owners_.end()) {
+      return owner->second;
+    }
+    std::unordered_map<int, std::pair<int, int> >::iterator parked = parked_.find(index);
+    if (parked != parked_.end() && parked->second.second <= time) {
+      return parked->second.first;
+    }
+    return kFree;
+  }
+
+  /* True if no robot passes through or parks on cell at time or later, so a robot may park there */
+  bool ReservationTable::IsFreeFrom(ModelCoordinates cell, int time) {
+    int index = Index(cell.GetX(), cell.GetY());
+    if (parked_.count(index) != 0) {
+      return false;
+    }
+    std::unordered_map<int, std::pair<int, int> >::iterator last_visit = last_visits_.find(index);
+    return last_visit == last_visits_.end() || last_visit->second.first < time;
+  }
+
+  /* The robot that is last in cell, or kFree */
+  int ReservationTable::GetLastOwner(ModelCoordinates cell) {
+    int index = Index(cell.GetX(), cell.GetY());
+    std::unordered_map<int, std::pair<int, int> >::iterator parked = parked_.find(index);
+    if (parked != parked_.end()) {
+      return parked->second.first;
+    }
+    std::unordered_map<int, std::pair<int, int> >::iterator last_visit = last_visits_.find(index);
+    return last_visit == last_visits_.end() ? kFree : last_visit->second.second;
+  }
+
+  int ReservationTable::Index(int x, int y) {
+    return y * width_ + x;
+  }
+
+  std::uint64_t ReservationTable::Key(int cell, int time) {
+    return static_cast<std::uint64_t>(time) << 32 | static_cast<std::uint32_t>(cell);
+  }
+
+  const int CooperativePlanner::kFootprint;
+  const int CooperativePlanner::kMaxDelay;
+  const int CooperativePlanner::kMaxRepairs;
+  const int CooperativePlanner::kMaxExpansions;
+
+  CooperativePlanner::CooperativePlanner() {
+  }
+
+  std::vector<std::deque<ModelCoordinates> > CooperativePlanner::Plan(WorldModel *model, const std::vector<FleetTask> &tasks) {
+    std::cout << "Planning a fleet of " << tasks.size() << " robots...." << std::endl;
+    std::vector<int> order(tasks.size());
+    for (std::size_t robot = 0; robot < tasks.size(); robot++) {
+      order[robot] = robot;
+    }
+    std::stable_sort(order.begin(), order.end(), [&tasks](int a, int b) {
+      return tasks[a].priority > tasks[b].priority;
+    });
+    ReservationTable table(model->GetWidth(), model->GetHeight(), kFootprint);
+    ReservationTable empty(model->GetWidth(), model->GetHeight(), kFootprint);
+    std::vector<std::deque<ModelCoordinates> > paths(tasks.size());
+    std::vector<bool> unreachable(tasks.size(), false);
+    for (std::size_t robot = 0; robot < tasks.size(); robot++) {
+      if (!IsInside(model, tasks[robot].start) || !IsInside(model, tasks[robot].goal)) {
+        std::cout << "Robot " << robot + 1 << " starts or ends off the map." << std::endl;
+        unreachable[robot] = true;
+      }
+    }
+    for (int repair = 0;; repair++) {
+      table.Clear();
+      int blocked = -1;
+      for (std::size_t rank = 0; rank < order.size() && blocked < 0; rank++) {
+        int robot = order[rank];
+        paths[robot].clear();
+        if (unreachable[robot]) {
+          continue;
+        }
+        paths[robot] = Search(model, tasks[robot], &table);
+        if (paths[robot].empty()) {
+          blocked = rank;
+        } else {
+          table.Reserve(robot, paths[robot]);
+        }
+      }
+      if (blocked < 0) {
+        break;
+      }
+      int robot = order[blocked];
+      int blocker = FindBlocker(Search(model, tasks[robot], &empty), &table);
+      if (blocker == ReservationTable::kFree) {
+        std::cout << "Robot " << robot + 1 << " cannot reach its goal." << std::endl;
+        unreachable[robot] = true;
+        continue;
+      }
+      if (repair == kMaxRepairs) {
+        std::cout << "Robot " << robot + 1 << " is still blocked after " << kMaxRepairs << " repairs." << std::endl;
+        for (std::size_t rank = blocked + 1; rank < order.size(); rank++) {
+          paths[order[rank]].clear();
+        }
+        break;
+      }
+      std::cout << "Robot " << robot + 1 << " is blocked by robot " << blocker + 1 << ", planning it first." << std::endl;
+      order.erase(order.begin() + blocked);
+      order.insert(std::find(order.begin(), order.end(), blocker), robot);
+    }
+    return paths;
+  }
+
+  bool CooperativePlanner::IsInside(WorldModel *model, ModelCoordinates cell) {
+    return cell.GetX() >= 0 && cell.GetY() >= 0 && cell.GetX() < model->GetWidth() && cell.GetY() < model->GetHeight();
+  }
+
+  /*
+   * Space-time A*. A robot may stop at its goal only once no other robot
+   * will pass through the goal afterwards. Searches give up kMaxDelay steps
+   * after the time the robot would need with the map to itself, or after
+   * kMaxExpansions states.
+   */
+  std::deque<ModelCoordinates> CooperativePlanner::Search(WorldModel *model, const FleetTask &task, ReservationTable *table) {
+    std::deque<ModelCoordinates> path;
+    heuristic_.Reset(model);
+    heuristic_.Flood(task.goal);
+    int estimate = heuristic_.GetDistance(task.start);
+    if (estimate < 0 || table->GetOwner(task.start, 0) != ReservationTable::kFree) {
+      return path;
+    }
+    int width = model->GetWidth();
+    int height = model->GetHeight();
+    int horizon = estimate + kMaxDelay;
+    /* Ordered by estimated total time, then later times first so ties go deeper */
+    typedef std::tuple<int, int, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    std::unordered_set<std::uint64_t> seen;
+    nodes_.clear();
+    ModelCoordinates origin = task.start;
+    Node start = {origin.GetY() * width + origin.GetX(), 0, -1};
+    nodes_.push_back(start);
+    open.push(std::make_tuple(estimate, 0, 0));
+    seen.insert(start.cell);
+    for (int expanded = 0; !open.empty() && expanded < kMaxExpansions; expanded++) {
+      int index = std::get<2>(open.top());
+      open.pop();
+      Node node = nodes_[index];
+      ModelCoordinates cell(node.cell % width, node.cell / width);
+      if (cell.Equals(task.goal) && table->IsFreeFrom(cell, node.time)) {
+        for (int current = index; current >= 0; current = nodes_[current].parent) {
+          path.push_front(ModelCoordinates(nodes_[current].cell % width, nodes_[current].cell / width));
+        }
+        return path;
+      }
+      if (node.time >= horizon) {
+        continue;
+      }
+      int time = node.time + 1;
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+          ModelCoordinates next(cell.GetX() + dx, cell.GetY() + dy);
+          if (next.GetX() < 0 || next.GetY() < 0 || next.GetX() >= width || next.GetY() >= height) {
+            continue;
+          }
+          int distance = heuristic_.GetDistance(next);
+          if (distance < 0 || table->GetOwner(next, time) != ReservationTable::kFree) {
+            continue;
+          }
+          int next_cell = next.GetY() * width + next.GetX();
+          if (!seen.insert(static_cast<std::uint64_t>(time) << 32 | static_cast<std::uint32_t>(next_cell)).second) {
+            continue;
+          }
+          Node child = {next_cell, time, index};
+          nodes_.push_back(child);
+          open.push(std::make_tuple(time + distance, -time, nodes_.size() - 1));
+        }
+      }
+    }
+    return path;
+  }
+
+  /*
+   * The first robot whose reservation the path enters, else the robot
+   * that would pass through or park on the end of the path later, or kFree
+   */
+  int CooperativePlanner::FindBlocker(const std::deque<ModelCoordinates> &path, ReservationTable *table) {
+    for (std::size_t time = 0; time < path.size(); time++) {
+      int owner = table->GetOwner(path[time], time);
+      if (owner != ReservationTable::kFree) {
+        return owner;
+      }
+    }
+    return path.empty() ? ReservationTable::kFree : table->GetLastOwner(path.back());
+  }
+} // namespace jlbot
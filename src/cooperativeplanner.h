@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   cooperativeplanner.h
+ * Author: Johnathan Louie
+ *
+ * Created on May 1, 2017, 11:25 AM
+ */
+
+#ifndef COOPERATIVEPLANNER_H
+#define COOPERATIVEPLANNER_H
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "wavefrontengine.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /* One robot of a fleet; robots with higher priority are planned first */
+  struct FleetTask {
+    ModelCoordinates start;
+    ModelCoordinates goal;
+    int priority;
+  };
+
+  /*
+   * Which robot occupies which model cell at which time step. A robot
+   * occupies the square of cells within footprint of its center, and stays
+   * parked on the square around its last cell from its arrival on. Entries
+   * are keyed by time and cell packed into one integer.
+   */
+  class ReservationTable {
+  public:
+    static const int kFree = -1;
+    ReservationTable(int width, int height, int footprint);
+    void Clear();
+    void Reserve(int robot, const std::deque<ModelCoordinates> &path);
+    int GetOwner(ModelCoordinates cell, int time);
+    bool IsFreeFrom(ModelCoordinates cell, int time);
+    int GetLastOwner(ModelCoordinates cell);
+  private:
+    int width_;
+    int height_;
+    int footprint_;
+    std::unordered_map<std::uint64_t, int> owners_;
+    std::unordered_map<int, std::pair<int, int> > parked_;
+    std::unordered_map<int, std::pair<int, int> > last_visits_;
+    int Index(int x, int y);
+    static std::uint64_t Key(int cell, int time);
+  };
+
+  /*
+   * Prioritized planning for a fleet (Silver, "Cooperative Pathfinding").
+   * Robots are planned one at a time, highest priority first, with A* over
+   * cells and time steps that may wait in place, guided by the true
+   * distance to the goal from a wavefront. Each plan is written to a
+   * shared reservation table that later robots must stay out of.
+   *
+   * When a robot cannot be planned, it is planned again ignoring the others,
+   * and the first robot whose reservation that plan runs into is the one
+   * blocking it. The blocked robot is moved ahead of the blocker and the
+   * fleet is planned again, up to kMaxRepairs times.
+   */
+  class CooperativePlanner {
+  public:
+    CooperativePlanner();
+
+    /*
+     * One path per task, in task order, with one cell per time step; a
+     * repeated cell is a wait. Robots that could not be planned, or that
+     * start or end off the map, get an empty path. Robots are numbered
+     * from 1 in the log, in task order.
+     */
+    std::vector<std::deque<ModelCoordinates> > Plan(WorldModel *model, const std::vector<FleetTask> &tasks);
+  private:
+    static const int kFootprint = 3;
+    static const int kMaxDelay = 200;
+    static const int kMaxRepairs = 8;
+    static const int kMaxExpansions = 200000;
+
+    struct Node {
+      int cell;
+      int time;
+      int parent;
+    };
+    WavefrontEngine heuristic_;
+    std::vector<Node> nodes_;
+    std::deque<ModelCoordinates> Search(WorldModel *model, const FleetTask &task, ReservationTable *table);
+    int FindBlocker(const std::deque<ModelCoordinates> &path, ReservationTable *table);
+    static bool IsInside(WorldModel *model, ModelCoordinates cell);
+  };
+} // namespace jlbot
+#endif /* COOPERATIVEPLANNER_H */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   debugartifacts.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 9, 2017, 1:26 PM
+ */
+
+#include "debugartifacts.h"
+#include <fstream>
+#include <iostream>
+
+namespace jlbot {
+
+  DebugArtifacts::Snapshot::Snapshot(WorldModel *model) {
+    width_ = model->GetWidth();
+    height_ = model->GetHeight();
+    const unsigned char *cells = model->GetCells();
+    cells_.assign(cells, cells + static_cast<std::size_t>(width_) * height_);
+  }
+
+  int DebugArtifacts::Snapshot::GetWidth() {
+    return width_;
+  }
+
+  int DebugArtifacts::Snapshot::GetHeight() {
+    return height_;
+  }
+
+  const std::vector<unsigned char> &DebugArtifacts::Snapshot::GetCells() {
+    return cells_;
+  }
+
+  DebugArtifacts::DebugArtifacts(bool enabled) : enabled_(enabled), stopping_(false) {
+    if (enabled_) {
+      writer_ = std::thread(&DebugArtifacts::Run, this);
+    }
+  }
+
+  /* Finishes writing everything already queued */
+  DebugArtifacts::~DebugArtifacts() {
+    if (!enabled_) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+  }
+
+  /* Queues an image of model and returns the captured map for later path overlays */
+  std::shared_ptr<DebugArtifacts::Snapshot> DebugArtifacts::SaveMap(std::string filename, WorldModel *model) {
+    if (!enabled_) {
+      return std::shared_ptr<Snapshot>();
+    }
+    Job job;
+    job.filename = filename;
+    job.map = std::make_shared<Snapshot>(model);
+    Enqueue(job);
+    return job.map;
+  }
+
+  /* Queues an image of map with path drawn over it */
+  void DebugArtifacts::SavePath(std::string filename, std::shared_ptr<Snapshot> map, std::deque<ModelCoordinates> path) {
+    if (!enabled_ || !map) {
+      return;
+    }
+    Job job;
+    job.filename = filename;
+    job.map = map;
+    job.path = path;
+    Enqueue(job);
+  }
+
+  void DebugArtifacts::Enqueue(Job job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(job);
+    }
+    wake_.notify_one();
+  }
+
+  void DebugArtifacts::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [this] {
+        return stopping_ || !jobs_.empty();
+      });
+      if (jobs_.empty()) {
+        return;
+      }
+      Job job = jobs_.front();
+      jobs_.pop_front();
+      lock.unlock();
+      Write(job);
+      lock.lock();
+    }
+  }
+
+  void DebugArtifacts::Write(Job job) {
+    Snapshot *map = job.map.get();
+    std::string image;
+    if (job.path.empty()) {
+      image = WorldModel::EncodePnm(map->GetCells().data(), map->GetWidth(), map->GetHeight());
+    } else {
+      std::vector<unsigned char> cells = map->GetCells();
+      for (ModelCoordinates i : job.path) {
+        cells[static_cast<std::size_t>(i.GetY()) * map->GetWidth() + i.GetX()] = WorldModel::kPath;
+      }
+      image = WorldModel::EncodePnm(cells.data(), map->GetWidth(), map->GetHeight());
+    }
+    std::ofstream stream(job.filename, std::ios::binary);
+    stream.write(image.data(), image.size());
+    if (!stream) {
+      std::cerr << "Could not write " << job.filename << "." << std::endl;
+    }
+  }
+} // namespace jlbot
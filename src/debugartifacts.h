@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   debugartifacts.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 9, 2017, 1:26 PM
+ */
+
+#ifndef DEBUGARTIFACTS_H
+#define DEBUGARTIFACTS_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Writes debug images of the planning maps on a background thread. When
+   * disabled every call returns immediately. Paths are drawn as overlays on
+   * a captured map rather than on copies of the world model.
+   */
+  class DebugArtifacts {
+  public:
+
+    class Snapshot {
+    public:
+      Snapshot(WorldModel *model);
+      int GetWidth();
+      int GetHeight();
+      const std::vector<unsigned char> &GetCells();
+    private:
+      int width_;
+      int height_;
+      std::vector<unsigned char> cells_;
+    };
+    DebugArtifacts(bool enabled);
+    ~DebugArtifacts();
+    std::shared_ptr<Snapshot> SaveMap(std::string filename, WorldModel *model);
+    void SavePath(std::string filename, std::shared_ptr<Snapshot> map, std::deque<ModelCoordinates> path);
+  private:
+
+    struct Job {
+      std::string filename;
+      std::shared_ptr<Snapshot> map;
+      std::deque<ModelCoordinates> path;
+    };
+    bool enabled_;
+    bool stopping_;
+    std::deque<Job> jobs_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread writer_;
+    void Enqueue(Job job);
+    void Run();
+    static void Write(Job job);
+  };
+} // namespace jlbot
+#endif /* DEBUGARTIFACTS_H */
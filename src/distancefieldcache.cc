@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   distancefieldcache.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 17, 2017, 4:35 PM
+ */
+
+#include "distancefieldcache.h"
+#include <iostream>
+
+namespace jlbot {
+
+  DistanceFieldCache::DistanceFieldCache(std::size_t capacity, WorkerPool *workers) {
+    capacity_ = capacity;
+    workers_ = workers;
+  }
+
+  /* Returns the current field of goal, building it on a repeated request, or NULL if goal has no field yet */
+  WavefrontEngine *DistanceFieldCache::Find(WorldModel *model, ModelCoordinates goal) {
+    int key = goal.GetY() * model->GetWidth() + goal.GetX();
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+      entries_.emplace_front();
+      entries_.front().key = key;
+      entries_.front().built = false;
+      index_[key] = entries_.begin();
+      if (entries_.size() > capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+      }
+      return NULL;
+    }
+    entries_.splice(entries_.begin(), entries_, found->second);
+    Entry &entry = entries_.front();
+    if (!entry.built || entry.revision != model->GetRevision()) {
+      std::cout << "Building the distance field of the goal...." << std::endl;
+      entry.field.SetWorkerPool(workers_);
+      entry.field.Reset(model);
+      entry.field.Flood(goal);
+      entry.field.ReleaseBuffers();
+      entry.built = true;
+      entry.revision = model->GetRevision();
+    }
+    return &entry.field;
+  }
+} // namespace jlbot
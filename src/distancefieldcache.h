@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   distancefieldcache.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 17, 2017, 4:35 PM
+ */
+
+#ifndef DISTANCEFIELDCACHE_H
+#define DISTANCEFIELDCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include "wavefrontengine.h"
+#include "workerpool.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Complete wavefront distance fields rooted at recently requested goals,
+   * least recently used first out. A path from any start to a cached goal is
+   * a walk down the field. Goals are only given a field the second time they
+   * are requested, so one-off goals do not push out the fixed destinations
+   * robots keep returning to. A field is rebuilt when the model has changed
+   * since it was computed.
+   */
+  class DistanceFieldCache {
+  public:
+    DistanceFieldCache(std::size_t capacity, WorkerPool *workers);
+    WavefrontEngine *Find(WorldModel *model, ModelCoordinates goal);
+  private:
+
+    struct Entry {
+      int key;
+      bool built;
+      unsigned long revision;
+      WavefrontEngine field;
+    };
+    std::size_t capacity_;
+    WorkerPool *workers_;
+    std::list<Entry> entries_;
+    std::unordered_map<int, std::list<Entry>::iterator> index_;
+  };
+} // namespace jlbot
+#endif /* DISTANCEFIELDCACHE_H */
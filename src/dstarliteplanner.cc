@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   dstarliteplanner.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 19, 2017, 10:15 AM
+ */
+
+#include "dstarliteplanner.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace jlbot {
+
+  DStarLitePlanner::DStarLitePlanner() : width_(0), height_(0), goal_(-1), start_(-1), key_modifier_(0), revision_(0) {
+  }
+
+  std::string DStarLitePlanner::GetName() {
+    return "D* Lite";
+  }
+
+  std::deque<ModelCoordinates> DStarLitePlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    if (model->GetWidth() != width_ || model->GetHeight() != height_) {
+      width_ = model->GetWidth();
+      height_ = model->GetHeight();
+      goal_ = -1;
+      grid_.Reset(model);
+    }
+    int source = grid_.Index(start);
+    int target = grid_.Index(goal);
+    if (target != goal_) {
+      Initialize(model, source, target);
+    } else {
+      /* Keys already queued were computed from the old start; raise every later key instead of requeueing */
+      key_modifier_ += grid_.Heuristic(start_, source);
+      start_ = source;
+      if (model->GetRevision() != revision_) {
+        Synchronize(model);
+      }
+    }
+    revision_ = model->GetRevision();
+    if (grid_.IsBlocked(start_)) {
+      return std::deque<ModelCoordinates>();
+    }
+    int expanded = ComputeShortestPath();
+    std::cout << "D* Lite expanded " << expanded << " cells." << std::endl;
+    return ExtractPath();
+  }
+
+  void DStarLitePlanner::Initialize(WorldModel *model, int start, int goal) {
+    grid_.Reset(model);
+    /* Like the wavefront, the goal cell may be entered even if it holds an obstacle */
+    grid_.SetBlocked(goal, false);
+    double infinity = std::numeric_limits<double>::infinity();
+    g_.assign(grid_.GetSize(), infinity);
+    rhs_.assign(grid_.GetSize(), infinity);
+    open_.Reset(grid_.GetSize());
+    goal_ = goal;
+    start_ = start;
+    key_modifier_ = 0;
+    rhs_[goal] = 0;
+    Enqueue(goal);
+  }
+
+  /* Compares the model with the grid of the last call and repairs the cells around every difference */
+  void DStarLitePlanner::Synchronize(WorldModel *model) {
+    const unsigned char *cells = model->GetCells();
+    std::vector<int> changed;
+    for (int y = 0; y < height_; y++) {
+      const unsigned char *row = cells + static_cast<std::size_t>(y) * width_;
+      int index = grid_.Index(ModelCoordinates(0, y));
+      for (int x = 0; x < width_; x++, index++) {
+        bool blocked = row[x] == WorldModel::kObstacle && index != goal_;
+        if (blocked != grid_.IsBlocked(index)) {
+          grid_.SetBlocked(index, blocked);
+          changed.push_back(index);
+        }
+      }
+    }
+    std::cout << "D* Lite repairing around " << changed.size() << " changed cells." << std::endl;
+    for (int cell : changed) {
+      UpdateVertex(cell);
+      for (int direction = 0; direction < 8; direction++) {
+        UpdateVertex(cell + grid_.GetOffset(direction));
+      }
+    }
+  }
+
+  /* Recomputes the one-step lookahead cost of cell and queues it if it is inconsistent */
+  void DStarLitePlanner::UpdateVertex(int cell) {
+    if (cell != goal_) {
+      double best = std::numeric_limits<double>::infinity();
+      if (!grid_.IsBlocked(cell)) {
+        for (int direction = 0; direction < 8; direction++) {
+          int neighbor = cell + grid_.GetOffset(direction);
+          if (!grid_.IsBlocked(neighbor)) {
+            best = std::min(best, g_[neighbor] + grid_.GetCost(direction));
+          }
+        }
+      }
+      rhs_[cell] = best;
+    }
+    if (g_[cell] != rhs_[cell]) {
+      Enqueue(cell);
+    } else if (open_.Contains(cell)) {
+      open_.Remove(cell);
+    }
+  }
+
+  /* Returns the number of cells expanded */
+  int DStarLitePlanner::ComputeShortestPath() {
+    int expanded = 0;
+    while (!open_.IsEmpty()) {
+      double start_cost = std::min(g_[start_], rhs_[start_]);
+      double start_key = start_cost + key_modifier_;
+      double top_key = open_.GetTopKey();
+      double top_tie = open_.GetTopTie();
+      bool top_first = top_key < start_key || (top_key == start_key && top_tie < start_cost);
+      if (!top_first && g_[start_] == rhs_[start_]) {
+        break;
+      }
+      int cell = open_.GetTop();
+      double cost = std::min(g_[cell], rhs_[cell]);
+      double key = cost + grid_.Heuristic(start_, cell) + key_modifier_;
+      expanded++;
+      if (top_key < key || (top_key == key && top_tie < cost)) {
+        open_.Push(cell, key, cost);
+      } else if (g_[cell] > rhs_[cell]) {
+        g_[cell] = rhs_[cell];
+        open_.Remove(cell);
+        for (int direction = 0; direction < 8; direction++) {
+          UpdateVertex(cell + grid_.GetOffset(direction));
+        }
+      } else {
+        g_[cell] = std::numeric_limits<double>::infinity();
+        UpdateVertex(cell);
+        for (int direction = 0; direction < 8; direction++) {
+          UpdateVertex(cell + grid_.GetOffset(direction));
+        }
+      }
+    }
+    return expanded;
+  }
+
+  void DStarLitePlanner::Enqueue(int cell) {
+    double cost = std::min(g_[cell], rhs_[cell]);
+    open_.Push(cell, cost + grid_.Heuristic(start_, cell) + key_modifier_, cost);
+  }
+
+  /* Follows the cheapest neighbor from the start to the goal */
+  std::deque<ModelCoordinates> DStarLitePlanner::ExtractPath() {
+    std::deque<ModelCoordinates> path;
+    if (g_[start_] == std::numeric_limits<double>::infinity()) {
+      return path;
+    }
+    path.push_back(grid_.ToCoordinates(start_));
+    for (int cell = start_, steps = 0; cell != goal_ && steps < grid_.GetSize(); steps++) {
+      int next = cell;
+      double best = std::numeric_limits<double>::infinity();
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + grid_.GetOffset(direction);
+        if (!grid_.IsBlocked(neighbor) && g_[neighbor] + grid_.GetCost(direction) < best) {
+          best = g_[neighbor] + grid_.GetCost(direction);
+          next = neighbor;
+        }
+      }
+      if (next == cell) {
+        return std::deque<ModelCoordinates>();
+      }
+      cell = next;
+      path.push_back(grid_.ToCoordinates(cell));
+    }
+    return path;
+  }
+} // namespace jlbot
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   dstarliteplanner.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 19, 2017, 10:15 AM
+ */
+
+#ifndef DSTARLITEPLANNER_H
+#define DSTARLITEPLANNER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "indexedheap.h"
+#include "searchplanners.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * D* Lite (Koenig and Likhachev, "D* Lite"). Searches from the goal toward
+   * the robot and keeps the search between calls. When the model has
+   * changed, the cells that differ from the last call are found and only
+   * the costs they affect are repaired. The robot may move between calls.
+   * A new goal or map size starts a new search.
+   */
+  class DStarLitePlanner : public Planner {
+  public:
+    DStarLitePlanner();
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+  private:
+    SearchGrid grid_;
+    IndexedHeap open_;
+    std::vector<double> g_;
+    std::vector<double> rhs_;
+    int width_;
+    int height_;
+    int goal_;
+    int start_;
+    double key_modifier_;
+    unsigned long revision_;
+    void Initialize(WorldModel *model, int start, int goal);
+    void Synchronize(WorldModel *model);
+    void UpdateVertex(int cell);
+    int ComputeShortestPath();
+    void Enqueue(int cell);
+    std::deque<ModelCoordinates> ExtractPath();
+  };
+} // namespace jlbot
+#endif /* DSTARLITEPLANNER_H */
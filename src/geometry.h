@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   geometry.h
+ * Author: Johnathan Louie
+ *
+ * Created on May 5, 2017, 2:10 PM
+ */
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <cmath>
+
+namespace jlbot {
+
+  constexpr double kPi = 3.14159265358979323846;
+
+  /* Plane vector kept in Cartesian form; nothing here converts to polar and back */
+  struct Vec2 {
+    double x;
+    double y;
+
+    constexpr Vec2() : x(0), y(0) {
+    }
+
+    constexpr Vec2(double x, double y) : x(x), y(y) {
+    }
+
+    constexpr Vec2 operator+(Vec2 other) const {
+      return Vec2(x + other.x, y + other.y);
+    }
+
+    constexpr Vec2 operator-(Vec2 other) const {
+      return Vec2(x - other.x, y - other.y);
+    }
+
+    constexpr Vec2 operator-() const {
+      return Vec2(-x, -y);
+    }
+
+    constexpr Vec2 operator*(double factor) const {
+      return Vec2(x * factor, y * factor);
+    }
+
+    Vec2 &operator+=(Vec2 other) {
+      x += other.x;
+      y += other.y;
+      return *this;
+    }
+
+    constexpr double Dot(Vec2 other) const {
+      return x * other.x + y * other.y;
+    }
+
+    /* Positive when other is counterclockwise of this */
+    constexpr double Cross(Vec2 other) const {
+      return x * other.y - y * other.x;
+    }
+
+    constexpr double LengthSquared() const {
+      return x * x + y * y;
+    }
+
+    double Length() const {
+      return std::sqrt(LengthSquared());
+    }
+
+    /* Same direction at length; the zero vector stays zero */
+    Vec2 Normalize(double length = 1) const {
+      double current = Length();
+      return current == 0 ? Vec2() : *this * (length / current);
+    }
+
+    /* Rotated counterclockwise by the angle whose cosine and sine are given */
+    constexpr Vec2 Rotate(double cosine, double sine) const {
+      return Vec2(cosine * x - sine * y, sine * x + cosine * y);
+    }
+  };
+
+  /*
+   * Angle in radians, kept in (-pi, pi] like atan2. Sums and differences
+   * of wrapped angles are at most one turn out, so wrapping them is a
+   * compare and an add; fmod is only reached for larger inputs.
+   */
+  class Angle {
+  public:
+    constexpr Angle() : radians_(0) {
+    }
+
+    static constexpr Angle FromRadians(double radians) {
+      return Angle(Wrap(radians));
+    }
+
+    /* Direction of vector, which should not be zero; atan2's -pi for a negative zero y is taken as pi */
+    static Angle Of(Vec2 vector) {
+      double radians = std::atan2(vector.y, vector.x);
+      return Angle(radians > -kPi ? radians : kPi);
+    }
+
+    constexpr double ToRadians() const {
+      return radians_;
+    }
+
+    constexpr Angle operator+(Angle other) const {
+      return FromRadians(radians_ + other.radians_);
+    }
+
+    constexpr Angle operator-(Angle other) const {
+      return FromRadians(radians_ - other.radians_);
+    }
+
+    /* Signed turn from this angle to target, the short way round */
+    constexpr double Difference(Angle target) const {
+      return (target - *this).radians_;
+    }
+
+    Vec2 ToVec2(double length = 1) const {
+      return Vec2(std::cos(radians_) * length, std::sin(radians_) * length);
+    }
+
+    /* vector rotated counterclockwise by this angle */
+    Vec2 Rotate(Vec2 vector) const {
+      return vector.Rotate(std::cos(radians_), std::sin(radians_));
+    }
+  private:
+    double radians_;
+
+    explicit constexpr Angle(double radians) : radians_(radians) {
+    }
+
+    static constexpr double Wrap(double radians) {
+      return radians > kPi ? (radians <= 3 * kPi ? radians - 2 * kPi : WrapFar(radians))
+          : radians <= -kPi ? (radians > -3 * kPi ? radians + 2 * kPi : WrapFar(radians)) : radians;
+    }
+
+    static double WrapFar(double radians) {
+      radians = std::fmod(radians + kPi, 2 * kPi);
+      if (radians <= 0) {
+        radians += 2 * kPi;
+      }
+      return radians - kPi;
+    }
+  };
+
+  /*
+   * Cosines and sines of count directions starting at first and step
+   * apart. Each one is the last rotated by step in double precision, so
+   * the whole array costs a single cosine and sine pair.
+   */
+  template <typename T>
+  void FillDirections(Angle first, double step, int count, T *cosines, T *sines) {
+    Vec2 direction = first.ToVec2();
+    double step_cosine = std::cos(step);
+    double step_sine = std::sin(step);
+    for (int i = 0; i < count; i++) {
+      cosines[i] = direction.x;
+      sines[i] = direction.y;
+      direction = direction.Rotate(step_cosine, step_sine);
+    }
+  }
+} // namespace jlbot
+#endif /* GEOMETRY_H */
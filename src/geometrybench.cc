@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   geometrybench.cc
+ * Author: Johnathan Louie
+ *
+ * Created on May 5, 2017, 4:40 PM
+ */
+
+/*
+ * Times the geometry of one steering step, a direction plus the obstacle
+ * push and the turn toward their sum, and of one scan's beam directions,
+ * with the polar Vector and fmod-wrapped Radians the robot used before
+ * next to Vec2 and Angle. The old types are copied here in cut down form
+ * so the comparison keeps building after their removal.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "geometry.h"
+
+namespace {
+
+  const int kCycles = 2000000;
+  const int kScans = 20000;
+  const int kBeams = 181;
+
+  class OldRadians {
+  public:
+    OldRadians(double radians) : radians_(Normalize(radians)) {
+    }
+
+    OldRadians(double x, double y) : radians_(Normalize(std::atan2(y, x))) {
+    }
+
+    double ToDouble() {
+      return radians_;
+    }
+
+    double Difference(OldRadians target) {
+      double angle = target.radians_ - radians_;
+      if (std::abs(angle) > M_PI) {
+        angle += angle > 0 ? -2 * M_PI : 2 * M_PI;
+      }
+      return angle;
+    }
+  private:
+    double radians_;
+
+    static double Normalize(double radians) {
+      radians = std::fmod(radians, 2 * M_PI);
+      return radians < 0 ? radians + 2 * M_PI : radians;
+    }
+  };
+
+  class OldVector {
+  public:
+    OldVector() : x_(0), y_(0) {
+    }
+
+    OldVector(OldRadians direction, double magnitude) : x_(magnitude * std::cos(direction.ToDouble())), y_(magnitude * std::sin(direction.ToDouble())) {
+    }
+
+    OldRadians GetDirection() {
+      return OldRadians(x_, y_);
+    }
+
+    double GetMagnitude() {
+      return std::sqrt(std::pow(x_, 2) + std::pow(y_, 2));
+    }
+
+    OldVector Add(OldVector other) {
+      OldVector sum;
+      sum.x_ = x_ + other.x_;
+      sum.y_ = y_ + other.y_;
+      return sum;
+    }
+  private:
+    double x_;
+    double y_;
+  };
+
+  /* Pull toward a point plus a push already summed in the robot's frame, then the turn toward their sum */
+  double OldCycle(double x, double y, double yaw, double push_x, double push_y) {
+    OldVector pull(OldRadians(10 - x, 5 - y), 1);
+    OldRadians facing(yaw);
+    OldVector push(OldRadians(std::atan2(-push_y, -push_x) + facing.ToDouble()), std::hypot(push_x, push_y));
+    OldVector total = pull.Add(push);
+    return facing.Difference(total.GetDirection()) + total.GetMagnitude();
+  }
+
+  double NewCycle(double x, double y, double yaw, double push_x, double push_y) {
+    jlbot::Vec2 pull = (jlbot::Vec2(10, 5) - jlbot::Vec2(x, y)).Normalize();
+    jlbot::Angle facing = jlbot::Angle::FromRadians(yaw);
+    jlbot::Vec2 total = pull + facing.Rotate(-jlbot::Vec2(push_x, push_y));
+    return facing.Difference(jlbot::Angle::Of(total)) + total.Length();
+  }
+
+  template <typename Cycle>
+  double TimeCycles(Cycle cycle, double *sink) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCycles; i++) {
+      double t = i * 1e-6;
+      *sink += cycle(t, 2 * t, 7 * t, 0.1 + t, 0.2 - t);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kCycles;
+  }
+}
+
+int main() {
+  double sink = 0;
+  double old_cycle = TimeCycles(OldCycle, &sink);
+  double new_cycle = TimeCycles(NewCycle, &sink);
+  std::vector<double> cosines(kBeams);
+  std::vector<double> sines(kBeams);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int scan = 0; scan < kScans; scan++) {
+    double first = scan * 1e-4 - jlbot::kPi / 2;
+    for (int i = 0; i < kBeams; i++) {
+      double bearing = first + i * (jlbot::kPi / 180);
+      cosines[i] = std::cos(bearing);
+      sines[i] = std::sin(bearing);
+    }
+    sink += cosines[scan % kBeams] + sines[scan % kBeams];
+  }
+  std::chrono::duration<double, std::nano> old_scan = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (int scan = 0; scan < kScans; scan++) {
+    jlbot::FillDirections(jlbot::Angle::FromRadians(scan * 1e-4 - jlbot::kPi / 2), jlbot::kPi / 180, kBeams, cosines.data(), sines.data());
+    sink += cosines[scan % kBeams] + sines[scan % kBeams];
+  }
+  std::chrono::duration<double, std::nano> new_scan = std::chrono::steady_clock::now() - start;
+  std::cout << "Steering geometry: " << old_cycle << " ns with Vector and Radians, " << new_cycle << " ns with Vec2 and Angle." << std::endl;
+  std::cout << kBeams << " beam directions: " << old_scan.count() / kScans << " ns with cos and sin per beam, "
+      << new_scan.count() / kScans << " ns with FillDirections." << std::endl;
+  std::cout << "(checksum " << sink << ")" << std::endl;
+  return EXIT_SUCCESS;
+}
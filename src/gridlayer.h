@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   gridlayer.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 4, 2017, 8:02 PM
+ */
+
+#ifndef GRIDLAYER_H
+#define GRIDLAYER_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "mappedfile.h"
+
+namespace jlbot {
+
+  /*
+   * One value per model cell. A layer either owns its values or borrows a
+   * read-only view into a mapped file, in which case the first write copies
+   * the values into private memory. Copies of a borrowed layer share pages.
+   */
+  template <typename T>
+  class GridLayer {
+  public:
+
+    GridLayer() : data_(NULL), size_(0) {
+    }
+
+    GridLayer(const GridLayer &other) {
+      CopyFrom(other);
+    }
+
+    GridLayer &operator=(const GridLayer &other) {
+      if (this != &other) {
+        CopyFrom(other);
+      }
+      return *this;
+    }
+
+    void Assign(std::size_t size, T value) {
+      backing_.reset();
+      owned_.assign(size, value);
+      data_ = owned_.data();
+      size_ = size;
+    }
+
+    void Borrow(const T *data, std::size_t size, std::shared_ptr<MappedFile> backing) {
+      std::vector<T>().swap(owned_);
+      backing_ = backing;
+      data_ = data;
+      size_ = size;
+    }
+
+    void Release() {
+      std::vector<T>().swap(owned_);
+      backing_.reset();
+      data_ = NULL;
+      size_ = 0;
+    }
+
+    T Get(std::size_t index) const {
+      return data_[index];
+    }
+
+    void Set(std::size_t index, T value) {
+      GetMutableData()[index] = value;
+    }
+
+    const T *GetData() const {
+      return data_;
+    }
+
+    T *GetMutableData() {
+      if (backing_) {
+        owned_.assign(data_, data_ + size_);
+        backing_.reset();
+        data_ = owned_.data();
+      }
+      return owned_.data();
+    }
+
+    std::size_t GetSize() const {
+      return size_;
+    }
+
+    bool IsAllocated() const {
+      return data_ != NULL;
+    }
+
+  private:
+    std::vector<T> owned_;
+    std::shared_ptr<MappedFile> backing_;
+    const T *data_;
+    std::size_t size_;
+
+    void CopyFrom(const GridLayer &other) {
+      backing_ = other.backing_;
+      size_ = other.size_;
+      if (backing_) {
+        std::vector<T>().swap(owned_);
+        data_ = other.data_;
+      } else {
+        owned_ = other.owned_;
+        data_ = other.data_ == NULL ? NULL : owned_.data();
+      }
+    }
+  };
+} // namespace jlbot
+#endif /* GRIDLAYER_H */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   indexedheap.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 16, 2017, 11:10 AM
+ */
+
+#include "indexedheap.h"
+
+namespace jlbot {
+
+  const int IndexedHeap::kAbsent;
+
+  /* Empties the heap and sizes the position table for cells 0 to cell_count - 1 */
+  void IndexedHeap::Reset(int cell_count) {
+    for (Entry entry : entries_) {
+      positions_[entry.cell] = kAbsent;
+    }
+    entries_.clear();
+    positions_.resize(cell_count, kAbsent);
+  }
+
+  bool IndexedHeap::IsEmpty() {
+    return entries_.empty();
+  }
+
+  bool IndexedHeap::Contains(int cell) {
+    return positions_[cell] != kAbsent;
+  }
+
+  int IndexedHeap::GetTop() {
+    return entries_[0].cell;
+  }
+
+  double IndexedHeap::GetTopKey() {
+    return entries_[0].key;
+  }
+
+  double IndexedHeap::GetTopTie() {
+    return entries_[0].tie;
+  }
+
+  int IndexedHeap::Pop() {
+    int top = entries_[0].cell;
+    Remove(top);
+    return top;
+  }
+
+  /* Inserts cell, or moves it to the new key if it is already queued */
+  void IndexedHeap::Push(int cell, double key, double tie) {
+    Entry entry = {key, tie, cell};
+    int position = positions_[cell];
+    if (position == kAbsent) {
+      entries_.push_back(entry);
+      positions_[cell] = entries_.size() - 1;
+      SiftUp(entries_.size() - 1);
+    } else if (IsBefore(entry, entries_[position])) {
+      entries_[position] = entry;
+      SiftUp(position);
+    } else {
+      entries_[position] = entry;
+      SiftDown(position);
+    }
+  }
+
+  void IndexedHeap::Remove(int cell) {
+    int position = positions_[cell];
+    positions_[cell] = kAbsent;
+    Entry last = entries_.back();
+    entries_.pop_back();
+    if (position < static_cast<int>(entries_.size())) {
+      Place(position, last);
+      SiftUp(position);
+      SiftDown(positions_[last.cell]);
+    }
+  }
+
+  void IndexedHeap::SiftUp(int position) {
+    Entry entry = entries_[position];
+    while (position > 0) {
+      int parent = (position - 1) / 2;
+      if (!IsBefore(entry, entries_[parent])) {
+        break;
+      }
+      Place(position, entries_[parent]);
+      position = parent;
+    }
+    Place(position, entry);
+  }
+
+  void IndexedHeap::SiftDown(int position) {
+    Entry entry = entries_[position];
+    int size = entries_.size();
+    for (int child = 2 * position + 1; child < size; child = 2 * position + 1) {
+      if (child + 1 < size && IsBefore(entries_[child + 1], entries_[child])) {
+        child++;
+      }
+      if (!IsBefore(entries_[child], entry)) {
+        break;
+      }
+      Place(position, entries_[child]);
+      position = child;
+    }
+    Place(position, entry);
+  }
+
+  bool IndexedHeap::IsBefore(const Entry &a, const Entry &b) {
+    return a.key < b.key || (a.key == b.key && a.tie < b.tie);
+  }
+
+  void IndexedHeap::Place(int position, Entry entry) {
+    entries_[position] = entry;
+    positions_[entry.cell] = position;
+  }
+} // namespace jlbot
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   indexedheap.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 16, 2017, 11:10 AM
+ */
+
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <vector>
+
+namespace jlbot {
+
+  /*
+   * Binary min-heap of cell indices keyed by cost, with ties broken by a
+   * second key. Each cell's position in the heap is kept in a table
+   * indexed by the cell, so a key can be lowered in place instead of
+   * pushing duplicates. Storage is reused across searches.
+   */
+  class IndexedHeap {
+  public:
+    void Reset(int cell_count);
+    bool IsEmpty();
+    bool Contains(int cell);
+    int GetTop();
+    double GetTopKey();
+    double GetTopTie();
+    int Pop();
+    void Push(int cell, double key, double tie = 0);
+    void Remove(int cell);
+  private:
+    static const int kAbsent = -1;
+
+    struct Entry {
+      double key;
+      double tie;
+      int cell;
+    };
+    std::vector<Entry> entries_;
+    std::vector<int> positions_;
+    void SiftUp(int position);
+    void SiftDown(int position);
+    void Place(int position, Entry entry);
+    static bool IsBefore(const Entry &a, const Entry &b);
+  };
+} // namespace jlbot
+#endif /* INDEXEDHEAP_H */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   jumppointplanner.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 23, 2017, 1:50 PM
+ */
+
+#include "jumppointplanner.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace jlbot {
+
+  std::string JumpPointPlanner::GetName() {
+    return "jump point search";
+  }
+
+  std::deque<ModelCoordinates> JumpPointPlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    grid_.Reset(model);
+    int source = grid_.Index(start);
+    target_ = grid_.Index(goal);
+    std::deque<ModelCoordinates> path;
+    if (grid_.IsBlocked(source)) {
+      return path;
+    }
+    /* Like the wavefront, the goal cell may be entered even if it holds an obstacle */
+    grid_.SetBlocked(target_, false);
+    tree_.Reset(grid_.GetSize());
+    IndexedHeap *open = tree_.GetOpen();
+    tree_.Visit(source, 0, source);
+    open->Push(source, grid_.Heuristic(source, target_));
+    int expanded = 0;
+    while (!open->IsEmpty() && open->GetTop() != target_) {
+      int cell = open->Pop();
+      tree_.Close(cell);
+      expanded++;
+      int parent = tree_.GetParent(cell);
+      int stride = grid_.GetStride();
+      int dx = Sign(cell % stride - parent % stride);
+      int dy = Sign(cell / stride - parent / stride);
+      if (cell == source) {
+        for (int ny = -1; ny <= 1; ny++) {
+          for (int nx = -1; nx <= 1; nx++) {
+            if (nx != 0 || ny != 0) {
+              Expand(cell, nx, ny);
+            }
+          }
+        }
+      } else if (dx != 0 && dy != 0) {
+        Expand(cell, dx, 0);
+        Expand(cell, 0, dy);
+        Expand(cell, dx, dy);
+        if (grid_.IsBlocked(cell - dx)) {
+          Expand(cell, -dx, dy);
+        }
+        if (grid_.IsBlocked(cell - dy * stride)) {
+          Expand(cell, dx, -dy);
+        }
+      } else if (dx != 0) {
+        Expand(cell, dx, 0);
+        for (int side = -1; side <= 1; side += 2) {
+          if (grid_.IsBlocked(cell + side * stride)) {
+            Expand(cell, dx, side);
+          }
+        }
+      } else {
+        Expand(cell, 0, dy);
+        for (int side = -1; side <= 1; side += 2) {
+          if (grid_.IsBlocked(cell + side)) {
+            Expand(cell, side, dy);
+          }
+        }
+      }
+    }
+    std::cout << "Jump point search expanded " << expanded << " cells." << std::endl;
+    if (!tree_.IsVisited(target_)) {
+      return path;
+    }
+    /* Fill in the runs between jump points */
+    int stride = grid_.GetStride();
+    for (int cell = target_; cell != source;) {
+      int parent = tree_.GetParent(cell);
+      int step = Sign(parent / stride - cell / stride) * stride + Sign(parent % stride - cell % stride);
+      for (; cell != parent; cell += step) {
+        path.push_front(grid_.ToCoordinates(cell));
+      }
+    }
+    path.push_front(start);
+    return path;
+  }
+
+  /* Queues the jump point reached from cell in direction (dx, dy), if there is one */
+  void JumpPointPlanner::Expand(int cell, int dx, int dy) {
+    int jump_point = Jump(cell, dx, dy);
+    if (jump_point == -1 || tree_.IsClosed(jump_point)) {
+      return;
+    }
+    double cost = tree_.GetCost(cell) + grid_.Heuristic(cell, jump_point);
+    if (!tree_.IsVisited(jump_point) || cost < tree_.GetCost(jump_point)) {
+      tree_.Visit(jump_point, cost, cell);
+      tree_.GetOpen()->Push(jump_point, cost + grid_.Heuristic(jump_point, target_));
+    }
+  }
+
+  /* Steps from cell in direction (dx, dy) and returns the first jump point, or -1 if the run hits an obstacle */
+  int JumpPointPlanner::Jump(int cell, int dx, int dy) {
+    int step = dy * grid_.GetStride() + dx;
+    while (true) {
+      cell += step;
+      if (grid_.IsBlocked(cell)) {
+        return -1;
+      }
+      if (cell == target_ || IsForced(cell, dx, dy)) {
+        return cell;
+      }
+      if (dx != 0 && dy != 0 && (Jump(cell, dx, 0) != -1 || Jump(cell, 0, dy) != -1)) {
+        return cell;
+      }
+    }
+  }
+
+  /*
+   * True if a neighbor of cell can only be reached optimally through cell
+   * when arriving in direction (dx, dy), because the cell beside the run
+   * is blocked.
+   */
+  bool JumpPointPlanner::IsForced(int cell, int dx, int dy) {
+    int stride = grid_.GetStride();
+    if (dx != 0 && dy != 0) {
+      return (grid_.IsBlocked(cell - dx) && !grid_.IsBlocked(cell - dx + dy * stride)) ||
+          (grid_.IsBlocked(cell - dy * stride) && !grid_.IsBlocked(cell + dx - dy * stride));
+    } else if (dx != 0) {
+      return (grid_.IsBlocked(cell + stride) && !grid_.IsBlocked(cell + stride + dx)) ||
+          (grid_.IsBlocked(cell - stride) && !grid_.IsBlocked(cell - stride + dx));
+    }
+    return (grid_.IsBlocked(cell + 1) && !grid_.IsBlocked(cell + 1 + dy * stride)) ||
+        (grid_.IsBlocked(cell - 1) && !grid_.IsBlocked(cell - 1 + dy * stride));
+  }
+
+  int JumpPointPlanner::Sign(int value) {
+    return (value > 0) - (value < 0);
+  }
+} // namespace jlbot
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   jumppointplanner.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 23, 2017, 1:50 PM
+ */
+
+#ifndef JUMPPOINTPLANNER_H
+#define JUMPPOINTPLANNER_H
+
+#include <deque>
+#include <string>
+#include "searchplanners.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Jump Point Search (Harabor and Grastien, "Online Graph Pruning for
+   * Pathfinding on Grid Maps"). A* that only queues the cells where an
+   * optimal path may turn: from each cell it scans straight and diagonal
+   * runs until it meets the goal or a cell with a forced neighbor. The
+   * jump points are joined by straight or diagonal runs of cells, so the
+   * path is filled back in to one cell per step.
+   */
+  class JumpPointPlanner : public Planner {
+  public:
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+  private:
+    SearchGrid grid_;
+    SearchTree tree_;
+    int target_;
+    int Jump(int cell, int dx, int dy);
+    bool IsForced(int cell, int dx, int dy);
+    void Expand(int cell, int dx, int dy);
+    static int Sign(int value);
+  };
+} // namespace jlbot
+#endif /* JUMPPOINTPLANNER_H */
@@ -23,44 +23,141 @@
  * Created on March 16, 2017, 7:39 PM
  */
 
+#include <cstdlib>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <libplayerc++/playerc++.h>
 #include "actors.h"
+#include "debugartifacts.h"
 #include "misc.h"
 #include "planners.h"
+#include "sensorfeed.h"
 #include "sensors.h"
+#include "trajectory.h"
+
+/*
+ * Plans a fleet sharing the map without driving: each robot is a start and
+ * a goal, listed from the highest priority down. Prints when each robot
+ * arrives, in time steps of one cell.
+ */
+static int PlanFleet(int argc, char** argv) {
+  std::vector<jlbot::WorldCoordinates> starts;
+  std::vector<jlbot::WorldCoordinates> goals;
+  std::vector<int> priorities;
+  for (int i = 2; i + 3 < argc; i += 4) {
+    starts.push_back(jlbot::WorldCoordinates(strtod(argv[i], NULL), strtod(argv[i + 1], NULL)));
+    goals.push_back(jlbot::WorldCoordinates(strtod(argv[i + 2], NULL), strtod(argv[i + 3], NULL)));
+    priorities.push_back(argc - i);
+  }
+  jlbot::DebugArtifacts debug(std::getenv("JLBOT_DEBUG_MAPS") != NULL);
+  jlbot::Navigator navigator(&debug);
+  std::vector<std::deque<jlbot::WorldCoordinates> > paths = navigator.PlanFleet(starts, goals, priorities);
+  int unplanned = 0;
+  for (std::size_t robot = 0; robot < paths.size(); robot++) {
+    if (paths[robot].empty()) {
+      std::cout << "Robot " << robot + 1 << " from " << starts[robot].ToString() << " could not be planned." << std::endl;
+      unplanned++;
+    } else {
+      std::cout << "Robot " << robot + 1 << " from " << starts[robot].ToString() << " reaches " << paths[robot].back().ToString() << " after " << paths[robot].size() - 1 << " steps." << std::endl;
+    }
+  }
+  return unplanned == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
 int main(int argc, char** argv) {
-  if (argc != 3) {
-    std::cout << "USAGE: jlbot x y" << std::endl;
+  if (argc > 1 && std::string(argv[1]) == "--fleet") {
+    if (argc < 6 || (argc - 2) % 4 != 0) {
+      std::cout << "USAGE: jlbot --fleet x y goal_x goal_y [x y goal_x goal_y ...]" << std::endl;
+      return EXIT_FAILURE;
+    }
+    try {
+      return PlanFleet(argc, argv);
+    } catch (std::exception &error) {
+      std::cerr << error.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (argc < 3 || argc % 2 == 0) {
+    std::cout << "USAGE: jlbot x y [x y ...]" << std::endl;
+    std::cout << "       jlbot --fleet x y goal_x goal_y [x y goal_x goal_y ...]" << std::endl;
     return EXIT_FAILURE;
   }
   try {
     std::cout << "Connecting to player server...." << std::endl;
     jlbot::Robot *robot = new jlbot::Robot();
-    double goal_x = strtod(argv[1], NULL);
-    double goal_y = strtod(argv[2], NULL);
-    jlbot::WorldCoordinates goal(goal_x, goal_y);
-    std::cout << "Goal set to " << goal.ToString() << "." << std::endl;
-    jlbot::Sense *sensors = new jlbot::Sense(robot);
-    robot->Read();
+    std::vector<jlbot::WorldCoordinates> goals;
+    for (int i = 1; i + 1 < argc; i += 2) {
+      double goal_x = strtod(argv[i], NULL);
+      double goal_y = strtod(argv[i + 1], NULL);
+      goals.push_back(jlbot::WorldCoordinates(goal_x, goal_y));
+      std::cout << "Goal set to " << goals.back().ToString() << "." << std::endl;
+    }
+    jlbot::SensorFeed feed(robot);
+    feed.Start();
+    feed.WaitForSnapshot();
+    jlbot::Sense *sensors = new jlbot::Sense(&feed);
+    sensors->Refresh();
     jlbot::WorldCoordinates current_position = sensors->GetCurrentPosition();
-    jlbot::Navigator navigator(current_position, goal);
-    if (!navigator.HasPath()) {
-      return EXIT_SUCCESS;
+    /* Set JLBOT_DEBUG_MAPS to write the planning maps as images */
+    jlbot::DebugArtifacts debug(std::getenv("JLBOT_DEBUG_MAPS") != NULL);
+    /* Set JLBOT_PLANNER to astar, bidirectional, dstarlite, jps, thetastar or clearance to replace the wavefront */
+    const char *planner = std::getenv("JLBOT_PLANNER");
+    jlbot::Navigator navigator(&debug, planner == NULL ? "wavefront" : planner);
+    /* Several goals make a round, visited in the order that drives the least */
+    std::size_t requested = goals.size();
+    if (goals.size() > 1) {
+      goals = navigator.PlanRound(current_position, goals);
+    }
+    int abandoned = requested - goals.size();
+    /* Set JLBOT_CONTROL_HZ to change the control rate */
+    const char *control_rate = std::getenv("JLBOT_CONTROL_HZ");
+    /* Set JLBOT_REPULSION_GAIN and JLBOT_REPULSION_FALLOFF to tune how hard and how far obstacles push */
+    const char *gain = std::getenv("JLBOT_REPULSION_GAIN");
+    const char *falloff = std::getenv("JLBOT_REPULSION_FALLOFF");
+    jlbot::ObstacleField obstacle_field(gain == NULL ? jlbot::ObstacleField::kDefaultGain : strtod(gain, NULL),
+        falloff == NULL ? jlbot::ObstacleField::kDefaultFalloff : strtod(falloff, NULL));
+    jlbot::Act act(&feed, sensors, control_rate == NULL ? 20 : strtod(control_rate, NULL), obstacle_field, navigator.GetMapper());
+    for (jlbot::WorldCoordinates goal : goals) {
+      if (!navigator.PlanPath(sensors->GetCurrentPosition(), goal)) {
+        std::cout << "Skipping unreachable goal " << goal.ToString() << "." << std::endl;
+        abandoned++;
+        continue;
+      }
+      /* Map changes off the rest of the path are followed through; a blocked path is replanned with the robot stopped */
+      jlbot::Trajectory trajectory = navigator.GetTrajectory(act.GetSpeed());
+      bool reached = true;
+      while (!act.Follow(&trajectory)) {
+        if (!navigator.UpdateMap(&trajectory, sensors->GetCurrentPosition())) {
+          continue;
+        }
+        act.Stop();
+        if (!navigator.Replan(sensors->GetCurrentPosition())) {
+          std::cout << "No path around the new obstacles, giving up on " << goal.ToString() << "." << std::endl;
+          reached = false;
+          break;
+        }
+        trajectory = navigator.GetTrajectory(act.GetSpeed());
+      }
+      if (reached) {
+        std::cout << "Robot reached " << goal.ToString() << "." << std::endl;
+      } else {
+        abandoned++;
+      }
     }
-    jlbot::Pilot pilot = navigator.GetPilot();
-    jlbot::Act act(robot, sensors);
-    while (pilot.HasObjectives()) {
-      jlbot::WorldCoordinates waypoint = pilot.GetNextObjective();
-      act.GoTo(waypoint);
-      pilot.ReachedObjective();
+    if (abandoned > 0) {
+      std::cout << "Gave up on " << abandoned << " of " << requested << " goals." << std::endl;
+    } else {
+      std::cout << "Robot reached the goal." << std::endl;
     }
-    std::cout << "Robot reached the goal." << std::endl;
   } catch (PlayerCc::PlayerError &error) {
     std::cerr << error << std::endl;
     return EXIT_FAILURE;
+  } catch (std::exception &error) {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
   }
   return EXIT_SUCCESS;
 }
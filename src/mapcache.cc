@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   mapcache.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 4, 2017, 8:02 PM
+ */
+
+#include "mapcache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <dirent.h>
+#include <limits>
+#include <unistd.h>
+
+namespace jlbot {
+
+  static const char kMagic[8] = {'J', 'L', 'B', 'O', 'T', 'M', 'A', 'P'};
+
+  /* The expected model size is read from the map's header, so a cache of another size is rejected */
+  MapCache::MapCache(std::string map_filename, int obstacle_growth) : map_filename_(map_filename) {
+    MappedFile map(map_filename);
+    int pnm_width;
+    int pnm_height;
+    WorldModel::ReadPnmHeader(map.GetData(), map.GetSize(), &pnm_width, &pnm_height);
+    width_ = pnm_width / WorldModel::kScaleMap;
+    height_ = pnm_height / WorldModel::kScaleMap;
+    key_ = Hash(map.GetData(), map.GetSize(), kVersion);
+    std::uint64_t parameters[] = {static_cast<std::uint64_t>(WorldModel::kScaleMap), static_cast<std::uint64_t>(obstacle_growth)};
+    key_ = Hash(reinterpret_cast<const unsigned char *>(parameters), sizeof(parameters), key_);
+    std::ostringstream stream;
+    stream << map_filename << "." << std::hex << std::setw(16) << std::setfill('0') << key_ << ".cache";
+    cache_filename_ = stream.str();
+  }
+
+  /* 64-bit FNV-1a */
+  std::uint64_t MapCache::Hash(const unsigned char *data, std::size_t size, std::uint64_t seed) {
+    std::uint64_t hash = 14695981039346656037ULL ^ seed;
+    for (std::size_t i = 0; i < size; i++) {
+      hash ^= data[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  std::size_t MapCache::Align(std::size_t offset) {
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+  }
+
+  /* False if a times b does not fit in a size_t */
+  bool MapCache::Multiply(std::size_t a, std::size_t b, std::size_t *product) {
+    if (a != 0 && b > std::numeric_limits<std::size_t>::max() / a) {
+      return false;
+    }
+    *product = a * b;
+    return true;
+  }
+
+  /* Layers are the scaled cells, the grown cells and the clearance of the scaled obstacles; false on overflow */
+  bool MapCache::GetLayerSize(int layer, std::size_t cell_count, std::size_t *size) {
+    return Multiply(cell_count, layer == 2 ? sizeof(float) : 1, size);
+  }
+
+  bool MapCache::Load(WorldModel *scaled, WorldModel *grown) {
+    std::shared_ptr<MappedFile> file;
+    try {
+      file = std::make_shared<MappedFile>(cache_filename_);
+    } catch (std::runtime_error &error) {
+      return false;
+    }
+    if (file->GetSize() < sizeof(Header)) {
+      return false;
+    }
+    Header header;
+    std::memcpy(&header, file->GetData(), sizeof(Header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+            || header.layer_count != kLayerCount || header.key != key_) {
+      return false;
+    }
+    if (header.width != width_ || header.height != height_ || width_ <= 0 || height_ <= 0) {
+      return false;
+    }
+    std::size_t cell_count;
+    if (!Multiply(header.width, header.height, &cell_count)) {
+      return false;
+    }
+    for (std::uint32_t i = 0; i < kLayerCount; i++) {
+      std::size_t layer_size;
+      if (!GetLayerSize(i, cell_count, &layer_size) || header.layer_offsets[i] % kAlignment != 0
+              || header.layer_offsets[i] > file->GetSize() || layer_size > file->GetSize() - header.layer_offsets[i]) {
+        return false;
+      }
+    }
+    const unsigned char *data = file->GetData();
+    const float *clearances = reinterpret_cast<const float *>(data + header.layer_offsets[2]);
+    scaled->BorrowCells(header.width, header.height, data + header.layer_offsets[0], file);
+    scaled->BorrowClearances(clearances, file);
+    grown->BorrowCells(header.width, header.height, data + header.layer_offsets[1], file);
+    grown->BorrowClearances(clearances, file);
+    std::cout << "Loaded world model from " << cache_filename_ << "." << std::endl;
+    return true;
+  }
+
+  /* Writes to a temporary file and renames it so readers never see a partial cache */
+  void MapCache::Store(WorldModel *scaled, WorldModel *grown) {
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.layer_count = kLayerCount;
+    header.key = key_;
+    header.width = grown->GetWidth();
+    header.height = grown->GetHeight();
+    std::size_t cell_count = static_cast<std::size_t>(header.width) * header.height;
+    const void *layers[] = {scaled->GetCells(), grown->GetCells(), grown->GetClearances()};
+    std::size_t layer_sizes[kLayerCount];
+    std::size_t offset = Align(sizeof(Header));
+    for (std::uint32_t i = 0; i < kLayerCount; i++) {
+      GetLayerSize(i, cell_count, &layer_sizes[i]);
+      header.layer_offsets[i] = offset;
+      offset = Align(offset + layer_sizes[i]);
+    }
+    std::ostringstream temporary_name;
+    temporary_name << cache_filename_ << ".tmp." << getpid();
+    std::string temporary_filename = temporary_name.str();
+    std::ofstream stream(temporary_filename, std::ios::binary);
+    std::vector<char> padding(kAlignment, 0);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    std::size_t written = sizeof(Header);
+    for (std::uint32_t i = 0; i < kLayerCount; i++) {
+      stream.write(padding.data(), header.layer_offsets[i] - written);
+      stream.write(static_cast<const char *>(layers[i]), layer_sizes[i]);
+      written = header.layer_offsets[i] + layer_sizes[i];
+    }
+    stream.close();
+    if (!stream || std::rename(temporary_filename.c_str(), cache_filename_.c_str()) != 0) {
+      std::remove(temporary_filename.c_str());
+      std::cerr << "Could not write map cache " << cache_filename_ << "." << std::endl;
+      return;
+    }
+    std::cout << "Saved world model to " << cache_filename_ << "." << std::endl;
+    RemoveStaleCaches();
+  }
+
+  /* Deletes caches of this map file made under other keys, named <map>.<16 hex digits>.cache */
+  void MapCache::RemoveStaleCaches() {
+    std::string::size_type slash = map_filename_.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : map_filename_.substr(0, slash + 1);
+    std::string prefix = (slash == std::string::npos ? map_filename_ : map_filename_.substr(slash + 1)) + ".";
+    std::string suffix = ".cache";
+    DIR *entries = opendir(directory.c_str());
+    if (entries == NULL) {
+      return;
+    }
+    while (dirent *entry = readdir(entries)) {
+      std::string name = entry->d_name;
+      if (name.size() != prefix.size() + 16 + suffix.size() || name.compare(0, prefix.size(), prefix) != 0
+              || name.compare(prefix.size() + 16, suffix.size(), suffix) != 0) {
+        continue;
+      }
+      std::string key = name.substr(prefix.size(), 16);
+      std::string path = slash == std::string::npos ? name : directory + name;
+      if (key.find_first_not_of("0123456789abcdef") == std::string::npos && path != cache_filename_) {
+        std::remove(path.c_str());
+        std::cout << "Removed stale map cache " << path << "." << std::endl;
+      }
+    }
+    closedir(entries);
+  }
+} // namespace jlbot
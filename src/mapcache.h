@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   mapcache.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 4, 2017, 8:02 PM
+ */
+
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <cstdint>
+#include <string>
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Preprocessed planning maps saved next to the source map. The cache file
+   * name and header carry a key made from the map contents, the map scale and
+   * the obstacle growth, so a stale cache is never used, and storing a new
+   * cache removes the ones made under other keys. Loaded layers are
+   * read-only mappings that every process on the host shares.
+   */
+  class MapCache {
+  public:
+    MapCache(std::string map_filename, int obstacle_growth);
+    bool Load(WorldModel *scaled, WorldModel *grown);
+    void Store(WorldModel *scaled, WorldModel *grown);
+  private:
+    static const std::uint32_t kVersion = 2;
+    static const std::uint32_t kLayerCount = 3;
+    static const std::size_t kAlignment = 64;
+
+    struct Header {
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t layer_count;
+      std::uint64_t key;
+      std::int32_t width;
+      std::int32_t height;
+      std::uint64_t layer_offsets[kLayerCount];
+    };
+    std::string map_filename_;
+    std::string cache_filename_;
+    std::uint64_t key_;
+    int width_;
+    int height_;
+    static std::uint64_t Hash(const unsigned char *data, std::size_t size, std::uint64_t seed);
+    static std::size_t Align(std::size_t offset);
+    static bool GetLayerSize(int layer, std::size_t cell_count, std::size_t *size);
+    static bool Multiply(std::size_t a, std::size_t b, std::size_t *product);
+    void RemoveStaleCaches();
+  };
+} // namespace jlbot
+#endif /* MAPCACHE_H */
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   mappedfile.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 2, 2017, 3:14 PM
+ */
+
+#include "mappedfile.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jlbot {
+
+  MappedFile::MappedFile(std::string filename) : descriptor_(-1), data_(MAP_FAILED), size_(0) {
+    descriptor_ = open(filename.c_str(), O_RDONLY);
+    if (descriptor_ == -1) {
+      throw std::runtime_error("Cannot open " + filename + ": " + std::strerror(errno));
+    }
+    struct stat status;
+    if (fstat(descriptor_, &status) == -1 || status.st_size == 0) {
+      close(descriptor_);
+      throw std::runtime_error("Cannot read " + filename);
+    }
+    size_ = status.st_size;
+    data_ = mmap(NULL, size_, PROT_READ, MAP_SHARED, descriptor_, 0);
+    if (data_ == MAP_FAILED) {
+      close(descriptor_);
+      throw std::runtime_error("Cannot map " + filename + ": " + std::strerror(errno));
+    }
+  }
+
+  MappedFile::~MappedFile() {
+    munmap(data_, size_);
+    close(descriptor_);
+  }
+
+  const unsigned char *MappedFile::GetData() {
+    return static_cast<const unsigned char *>(data_);
+  }
+
+  std::size_t MappedFile::GetSize() {
+    return size_;
+  }
+} // namespace jlbot
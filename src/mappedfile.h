@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   mappedfile.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 2, 2017, 3:14 PM
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace jlbot {
+
+  /* Read-only memory mapping of a whole file. Throws std::runtime_error if the file cannot be mapped. */
+  class MappedFile {
+  public:
+    MappedFile(std::string filename);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    const unsigned char *GetData();
+    std::size_t GetSize();
+  private:
+    int descriptor_;
+    void *data_;
+    std::size_t size_;
+  };
+} // namespace jlbot
+#endif /* MAPPEDFILE_H */
@@ -41,27 +41,36 @@ namespace jlbot {
     delete lp_;
   }
 
-  const WorldCoordinates WorldCoordinates::kOrigin(0, 0);
+  const int FloatBlock::kLanes;
 
   WorldCoordinates Robot::GetGps() {
     return WorldCoordinates(pp_->GetXPos(), pp_->GetYPos());
   }
 
-  double Robot::GetLaser(Radians direction) {
-    int index = Degrees(direction).ToAtan2() + 90;
-    return lp_->GetRange(index);
+  /* Copies the latest sweep into scan, reusing its range storage */
+  void Robot::GetScan(LaserScan *scan) {
+    scan->origin = GetGps();
+    scan->yaw = pp_->GetYaw();
+    scan->min_angle = lp_->GetMinAngle();
+    scan->resolution = lp_->GetScanRes();
+    scan->max_range = lp_->GetMaxRange();
+    scan->ranges.resize(lp_->GetCount());
+    for (std::size_t i = 0; i < scan->ranges.size(); i++) {
+      scan->ranges[i] = lp_->GetRange(i);
+    }
   }
 
   void Robot::Read() {
     server_->Read();
   }
 
-  void Robot::Move(double longitudinal_speed, double yaw_speed) {
-    pp_->SetSpeed(longitudinal_speed, yaw_speed);
+  /* True once an update is waiting, so the next Read will not block */
+  bool Robot::Peek(int milliseconds) {
+    return server_->Peek(milliseconds);
   }
 
-  Radians Robot::Facing() {
-    return Radians(pp_->GetYaw());
+  void Robot::Move(double longitudinal_speed, double yaw_speed) {
+    pp_->SetSpeed(longitudinal_speed, yaw_speed);
   }
 
   WorldCoordinates::WorldCoordinates() {
@@ -92,108 +101,13 @@ namespace jlbot {
     return std::sqrt(x + y);
   }
 
+  Vec2 WorldCoordinates::ToVec2() {
+    return Vec2(x_, y_);
+  }
+
   std::string WorldCoordinates::ToString() {
     std::ostringstream stream;
     stream << "(" << x_ << ", " << y_ << ")";
     return stream.str();
   }
-
-  Radians::Radians() {
-    radians_ = 0;
-  }
-
-  Radians::Radians(double radians) {
-    radians_ = Normalize(radians);
-  }
-
-  Radians::Radians(WorldCoordinates reference, WorldCoordinates target) {
-    double x = target.GetX() - reference.GetX();
-    double y = target.GetY() - reference.GetY();
-    radians_ = Normalize(std::atan2(y, x));
-  }
-
-  double Radians::Normalize(double radians) {
-    radians = std::fmod(radians, 2 * M_PI);
-    if (radians < 0) {
-      radians += 2 * M_PI;
-    }
-    return radians;
-  }
-
-  Radians Radians::Flip() {
-    return Radians(radians_ + M_PI);
-  }
-
-  /* returns angle as radians in domain 0 to 2 pi */
-  double Radians::ToDouble() {
-    return radians_;
-  }
-
-  /* returns angle as radians in domain -pi to +pi*/
-  double Radians::ToAtan2() {
-    if (radians_ <= M_PI) {
-      return radians_;
-    }
-    return radians_ - 2 * M_PI;
-  }
-
-  double Radians::Difference(Radians target) {
-    double angle = target.radians_ - radians_;
-    if (std::abs(angle) > M_PI) {
-      if (angle > 0) {
-        angle -= 2 * M_PI;
-      } else {
-        angle += 2 * M_PI;
-      }
-    }
-    return angle;
-  }
-
-  Degrees::Degrees() {
-  }
-
-  Degrees::Degrees(double degrees) {
-    double radians = DegreesToRadians(degrees);
-    angle_ = Radians(radians);
-  }
-
-  Degrees::Degrees(Radians angle) {
-    angle_ = angle;
-  }
-
-  Degrees::Degrees(WorldCoordinates reference, WorldCoordinates target) {
-    angle_ = Radians(reference, target);
-  }
-
-  double Degrees::RadiansToDegrees(double radians) {
-    return radians / M_PI * 180;
-  }
-
-  double Degrees::DegreesToRadians(double degrees) {
-    return degrees / 180 * M_PI;
-  }
-
-  double Degrees::ToDouble() {
-    return RadiansToDegrees(angle_.ToDouble());
-  }
-
-  double Degrees::ToAtan2() {
-    double a = ToDouble();
-    if (a <= 180) {
-      return a;
-    }
-    return a - 360;
-  }
-
-  double Degrees::Difference(Degrees target) {
-    return RadiansToDegrees(angle_.Difference(target.angle_));
-  }
-
-  Degrees Degrees::Flip() {
-    return Degrees(angle_.Flip());
-  }
-
-  Radians Degrees::ToRadians() {
-    return angle_;
-  }
 } // namespace jlbot
\ No newline at end of file
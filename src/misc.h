@@ -27,13 +27,14 @@
 #define MISC_H
 
 #include <string>
+#include <vector>
 #include <libplayerc++/playerc++.h>
+#include "geometry.h"
 
 namespace jlbot {
 
   class WorldCoordinates {
   public:
-    const static WorldCoordinates kOrigin;
     WorldCoordinates();
     WorldCoordinates(double x, double y);
     double GetX();
@@ -41,44 +42,26 @@ namespace jlbot {
     WorldCoordinates Add(WorldCoordinates other);
     double Distance(WorldCoordinates other);
     std::string ToString();
+    Vec2 ToVec2();
   private:
     double x_;
     double y_;
   };
 
-  class Radians {
-  public:
-    Radians();
-    Radians(double radians);
-    Radians(WorldCoordinates reference, WorldCoordinates target);
-    Radians Flip();
-
-    /* returns angle as radians in domain 0 to 2 pi */
-    double ToDouble();
-
-    /* returns angle as radians in domain -pi to +pi*/
-    double ToAtan2();
-    double Difference(Radians target);
-  private:
-    double radians_;
-    static double Normalize(double radians);
+  /* One laser sweep; beam i points min_angle + i * resolution from yaw */
+  struct LaserScan {
+    WorldCoordinates origin;
+    double yaw;
+    double min_angle;
+    double resolution;
+    double max_range;
+    std::vector<double> ranges;
   };
 
-  class Degrees {
-  public:
-    Degrees();
-    Degrees(double degrees);
-    Degrees(Radians angle);
-    Degrees(WorldCoordinates reference, WorldCoordinates target);
-    static double RadiansToDegrees(double radians);
-    static double DegreesToRadians(double degrees);
-    double ToDouble();
-    double ToAtan2();
-    double Difference(Degrees target);
-    Degrees Flip();
-    Radians ToRadians();
-  private:
-    Radians angle_;
+  /* Four floats on a 16 byte boundary, so arrays of blocks load aligned */
+  struct alignas(16) FloatBlock {
+    static const int kLanes = 4;
+    float values[kLanes];
   };
 
   class Robot {
@@ -86,10 +69,10 @@ namespace jlbot {
     Robot();
     ~Robot();
     WorldCoordinates GetGps();
-    double GetLaser(Radians direction);
+    void GetScan(LaserScan *scan);
     void Read();
+    bool Peek(int milliseconds);
     void Move(double longitudinal_speed, double yaw_speed);
-    Radians Facing();
   private:
     PlayerCc::PlayerClient *server_;
     PlayerCc::Position2dProxy *pp_;
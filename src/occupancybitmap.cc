@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   occupancybitmap.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 6, 2017, 9:47 PM
+ */
+
+#include "occupancybitmap.h"
+#include <algorithm>
+#include <cstdlib>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace jlbot {
+
+  OccupancyBitmap::OccupancyBitmap() : width_(0), height_(0), words_per_row_(0) {
+  }
+
+  /* Resizes to width x height cells, all free */
+  void OccupancyBitmap::Resize(int width, int height) {
+    width_ = width;
+    height_ = height;
+    words_per_row_ = (width + 63) / 64;
+    words_.assign(static_cast<std::size_t>(words_per_row_) * height, 0);
+  }
+
+  bool OccupancyBitmap::Get(int x, int y) {
+    std::uint64_t word = words_[static_cast<std::size_t>(y) * words_per_row_ + x / 64];
+    return (word >> (x % 64)) & 1;
+  }
+
+  void OccupancyBitmap::Set(int x, int y, bool obstacle) {
+    std::uint64_t &word = words_[static_cast<std::size_t>(y) * words_per_row_ + x / 64];
+    std::uint64_t mask = std::uint64_t(1) << (x % 64);
+    word = obstacle ? word | mask : word & ~mask;
+  }
+
+  /* Replaces row y with one bit per cell, set where the cell equals obstacle */
+  void OccupancyBitmap::PackRow(int y, const unsigned char *cells, unsigned char obstacle) {
+    std::uint64_t *row = words_.data() + static_cast<std::size_t>(y) * words_per_row_;
+    std::fill(row, row + words_per_row_, 0);
+    int x = 0;
+#ifdef __AVX2__
+    const __m256i match = _mm256_set1_epi8(static_cast<char>(obstacle));
+    for (; x + 32 <= width_; x += 32) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + x));
+      std::uint32_t bits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, match));
+      row[x / 64] |= static_cast<std::uint64_t>(bits) << (x % 64);
+    }
+#endif
+    for (; x < width_; x++) {
+      row[x / 64] |= static_cast<std::uint64_t>(cells[x] == obstacle) << (x % 64);
+    }
+  }
+
+  /* True if no cell from x_min to x_max inclusive on row y is an obstacle */
+  bool OccupancyBitmap::IsRowClear(int y, int x_min, int x_max) {
+    const std::uint64_t *row = GetRow(y);
+    int first = x_min / 64;
+    int last = x_max / 64;
+    std::uint64_t first_mask = ~std::uint64_t(0) << (x_min % 64);
+    std::uint64_t last_mask = ~std::uint64_t(0) >> (63 - x_max % 64);
+    if (first == last) {
+      return (row[first] & first_mask & last_mask) == 0;
+    }
+    std::uint64_t hits = (row[first] & first_mask) | (row[last] & last_mask);
+    for (int i = first + 1; i < last; i++) {
+      hits |= row[i];
+    }
+    return hits == 0;
+  }
+
+  /*
+   * Morphological dilation by a Euclidean disc: a cell becomes an obstacle
+   * if some obstacle lies within radius cells of it. Row dy of the disc has
+   * half width w, the largest integer with w * w + dy * dy <= radius * radius,
+   * so each row of the result is the OR of nearby rows dilated sideways.
+   */
+  void OccupancyBitmap::Dilate(double radius) {
+    if (radius < 1 || words_.empty()) {
+      return;
+    }
+    int reach = static_cast<int>(radius);
+    double radius_squared = radius * radius;
+    std::vector<std::uint64_t> horizontal = words_;
+    std::vector<std::uint64_t> result(words_.size(), 0);
+    for (int w = 0; w <= reach; w++) {
+      if (w > 0) {
+        ShiftOrRows(words_.data(), horizontal.data(), w);
+        ShiftOrRows(words_.data(), horizontal.data(), -w);
+      }
+      for (int dy = -reach; dy <= reach; dy++) {
+        int half_width = 0;
+        while ((half_width + 1.0) * (half_width + 1.0) + dy * dy <= radius_squared) {
+          half_width++;
+        }
+        if (half_width != w || std::abs(dy) >= height_) {
+          continue;
+        }
+        /* result row y |= horizontal row y + dy */
+        std::size_t rows = height_ - std::abs(dy);
+        std::size_t offset = static_cast<std::size_t>(std::abs(dy)) * words_per_row_;
+        if (dy >= 0) {
+          OrWords(horizontal.data() + offset, result.data(), rows * words_per_row_);
+        } else {
+          OrWords(horizontal.data(), result.data() + offset, rows * words_per_row_);
+        }
+      }
+    }
+    words_.swap(result);
+    ClearPadding();
+  }
+
+  /* Halves the resolution into coarse. A coarse cell is an obstacle if any of its four children is. */
+  void OccupancyBitmap::Downsample(OccupancyBitmap *coarse) {
+    coarse->Resize((width_ + 1) / 2, (height_ + 1) / 2);
+    for (int y = 0; y < coarse->height_; y++) {
+      const std::uint64_t *top = GetRow(2 * y);
+      const std::uint64_t *bottom = 2 * y + 1 < height_ ? GetRow(2 * y + 1) : top;
+      std::uint64_t *out = coarse->words_.data() + static_cast<std::size_t>(y) * coarse->words_per_row_;
+      for (int j = 0; j < words_per_row_; j++) {
+        out[j / 2] |= CompressPairs(top[j] | bottom[j]) << (32 * (j % 2));
+      }
+    }
+  }
+
+  /* ORs each pair of adjacent bits and packs the 32 results into the low half of the word */
+  std::uint64_t OccupancyBitmap::CompressPairs(std::uint64_t word) {
+    word = (word | (word >> 1)) & 0x5555555555555555ULL;
+    word = (word | (word >> 1)) & 0x3333333333333333ULL;
+    word = (word | (word >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    word = (word | (word >> 4)) & 0x00FF00FF00FF00FFULL;
+    word = (word | (word >> 8)) & 0x0000FFFF0000FFFFULL;
+    word = (word | (word >> 16)) & 0x00000000FFFFFFFFULL;
+    return word;
+  }
+
+  int OccupancyBitmap::GetWidth() {
+    return width_;
+  }
+
+  int OccupancyBitmap::GetHeight() {
+    return height_;
+  }
+
+  int OccupancyBitmap::GetWordsPerRow() {
+    return words_per_row_;
+  }
+
+  const std::uint64_t *OccupancyBitmap::GetRow(int y) {
+    return words_.data() + static_cast<std::size_t>(y) * words_per_row_;
+  }
+
+  /* out |= in moved shift cells along each row, toward larger x when shift is positive */
+  void OccupancyBitmap::ShiftOrRows(const std::uint64_t *in, std::uint64_t *out, int shift) {
+    int word_shift = std::abs(shift) / 64;
+    int bit_shift = std::abs(shift) % 64;
+    int n = words_per_row_;
+    for (int y = 0; y < height_; y++) {
+      const std::uint64_t *in_row = in + static_cast<std::size_t>(y) * n;
+      std::uint64_t *out_row = out + static_cast<std::size_t>(y) * n;
+      if (shift > 0) {
+        int j = word_shift;
+        if (j < n) {
+          /* First word has no lower neighbor to carry from */
+          out_row[j] |= in_row[0] << bit_shift;
+          j++;
+        }
+#ifdef __AVX2__
+        __m128i count = _mm_cvtsi32_si128(bit_shift);
+        __m128i carry_count = _mm_cvtsi32_si128(64 - bit_shift);
+        for (; j + 4 <= n; j += 4) {
+          __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in_row + j - word_shift));
+          __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in_row + j - word_shift - 1));
+          __m256i moved = _mm256_or_si256(_mm256_sll_epi64(current, count), _mm256_srl_epi64(previous, carry_count));
+          __m256i *target = reinterpret_cast<__m256i *>(out_row + j);
+          _mm256_storeu_si256(target, _mm256_or_si256(_mm256_loadu_si256(target), moved));
+        }
+#endif
+        for (; j < n; j++) {
+          std::uint64_t moved = in_row[j - word_shift] << bit_shift;
+          if (bit_shift != 0) {
+            moved |= in_row[j - word_shift - 1] >> (64 - bit_shift);
+          }
+          out_row[j] |= moved;
+        }
+      } else {
+        int j = 0;
+#ifdef __AVX2__
+        __m128i count = _mm_cvtsi32_si128(bit_shift);
+        __m128i carry_count = _mm_cvtsi32_si128(64 - bit_shift);
+        for (; j + 4 <= n - word_shift - 1; j += 4) {
+          __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in_row + j + word_shift));
+          __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in_row + j + word_shift + 1));
+          __m256i moved = _mm256_or_si256(_mm256_srl_epi64(current, count), _mm256_sll_epi64(next, carry_count));
+          __m256i *target = reinterpret_cast<__m256i *>(out_row + j);
+          _mm256_storeu_si256(target, _mm256_or_si256(_mm256_loadu_si256(target), moved));
+        }
+#endif
+        for (; j + word_shift < n; j++) {
+          std::uint64_t moved = in_row[j + word_shift] >> bit_shift;
+          if (bit_shift != 0 && j + word_shift + 1 < n) {
+            moved |= in_row[j + word_shift + 1] << (64 - bit_shift);
+          }
+          out_row[j] |= moved;
+        }
+      }
+    }
+  }
+
+  void OccupancyBitmap::OrWords(const std::uint64_t *in, std::uint64_t *out, std::size_t count) {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= count; i += 4) {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+      __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(out + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_or_si256(a, b));
+    }
+#endif
+    for (; i < count; i++) {
+      out[i] |= in[i];
+    }
+  }
+
+  /* Bits past the right edge of the map never hold obstacles */
+  void OccupancyBitmap::ClearPadding() {
+    int used = width_ % 64;
+    if (used == 0) {
+      return;
+    }
+    std::uint64_t mask = (std::uint64_t(1) << used) - 1;
+    for (int y = 0; y < height_; y++) {
+      words_[static_cast<std::size_t>(y) * words_per_row_ + words_per_row_ - 1] &= mask;
+    }
+  }
+} // namespace jlbot
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   occupancybitmap.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 6, 2017, 9:47 PM
+ */
+
+#ifndef OCCUPANCYBITMAP_H
+#define OCCUPANCYBITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jlbot {
+
+  /*
+   * One bit per cell, set for obstacles. Each row starts on a fresh 64-bit
+   * word so whole rows can be shifted and combined a word at a time; bit i
+   * of word j in a row is the cell at x = 64 * j + i.
+   */
+  class OccupancyBitmap {
+  public:
+    OccupancyBitmap();
+    void Resize(int width, int height);
+    bool Get(int x, int y);
+    void Set(int x, int y, bool obstacle);
+    void PackRow(int y, const unsigned char *cells, unsigned char obstacle);
+    bool IsRowClear(int y, int x_min, int x_max);
+    void Dilate(double radius);
+    void Downsample(OccupancyBitmap *coarse);
+    int GetWidth();
+    int GetHeight();
+    int GetWordsPerRow();
+    const std::uint64_t *GetRow(int y);
+  private:
+    int width_;
+    int height_;
+    int words_per_row_;
+    std::vector<std::uint64_t> words_;
+    void ShiftOrRows(const std::uint64_t *in, std::uint64_t *out, int shift);
+    void ClearPadding();
+    static void OrWords(const std::uint64_t *in, std::uint64_t *out, std::size_t count);
+    static std::uint64_t CompressPairs(std::uint64_t word);
+  };
+} // namespace jlbot
+#endif /* OCCUPANCYBITMAP_H */
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   occupancymapper.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 14, 2017, 9:40 AM
+ */
+
+#include "occupancymapper.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace jlbot {
+
+  const signed char OccupancyMapper::kHit;
+  const signed char OccupancyMapper::kMiss;
+  const signed char OccupancyMapper::kClamp;
+  const signed char OccupancyMapper::kOccupied;
+  const signed char OccupancyMapper::kFree;
+  const unsigned short OccupancyMapper::kStatic;
+
+  OccupancyMapper::OccupancyMapper(WorldModel *model, double obstacle_growth) {
+    model_ = model;
+    width_ = model->GetWidth();
+    height_ = model->GetHeight();
+    tiles_wide_ = (width_ + kTileSize - 1) / kTileSize;
+    int tiles_high = (height_ + kTileSize - 1) / kTileSize;
+    std::size_t size = static_cast<std::size_t>(width_) * height_;
+    log_odds_.assign(size, 0);
+    sensed_.assign(size, 0);
+    coverage_.resize(size);
+    const unsigned char *cells = model->GetCells();
+    for (std::size_t i = 0; i < size; i++) {
+      coverage_[i] = cells[i] == WorldModel::kObstacle ? kStatic : 0;
+    }
+    int radius = obstacle_growth;
+    for (int dy = -radius; dy <= radius; dy++) {
+      for (int dx = -radius; dx <= radius; dx++) {
+        if (dx * dx + dy * dy <= obstacle_growth * obstacle_growth) {
+          growth_offsets_.push_back(ModelCoordinates(dx, dy));
+        }
+      }
+    }
+    tile_dirty_.assign(static_cast<std::size_t>(tiles_wide_) * tiles_high, 0);
+  }
+
+  /* Traces every beam of the scan from the robot to its end point with Bresenham's algorithm */
+  void OccupancyMapper::Integrate(const LaserScan &scan) {
+    WorldCoordinates origin = scan.origin;
+    ModelCoordinates start = model_->WorldToModel(origin);
+    int x0 = start.GetX();
+    int y0 = start.GetY();
+    if (x0 < 0 || y0 < 0 || x0 >= width_ || y0 >= height_) {
+      return;
+    }
+    cosines_.resize(scan.ranges.size());
+    sines_.resize(scan.ranges.size());
+    FillDirections(Angle::FromRadians(scan.yaw + scan.min_angle), scan.resolution, scan.ranges.size(), cosines_.data(), sines_.data());
+    for (std::size_t i = 0; i < scan.ranges.size(); i++) {
+      bool hit = scan.ranges[i] < scan.max_range;
+      double range = std::min(scan.ranges[i], scan.max_range);
+      WorldCoordinates end_point(origin.GetX() + range * cosines_[i], origin.GetY() + range * sines_[i]);
+      ModelCoordinates end = model_->WorldToModel(end_point);
+      int x1 = end.GetX();
+      int y1 = end.GetY();
+      int dx = std::abs(x1 - x0);
+      int dy = -std::abs(y1 - y0);
+      int step_x = x0 < x1 ? 1 : -1;
+      int step_y = y0 < y1 ? 1 : -1;
+      int error = dx + dy;
+      for (int x = x0, y = y0;;) {
+        if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+          break;
+        }
+        if (x == x1 && y == y1) {
+          Update(x, y, hit ? kHit : kMiss);
+          break;
+        }
+        Update(x, y, kMiss);
+        int doubled = 2 * error;
+        if (doubled >= dy) {
+          error += dy;
+          x += step_x;
+        }
+        if (doubled <= dx) {
+          error += dx;
+          y += step_y;
+        }
+      }
+    }
+  }
+
+  bool OccupancyMapper::HasChanges() {
+    return !dirty_tiles_.empty();
+  }
+
+  /* Moves the tiles changed since the last call into tiles */
+  void OccupancyMapper::TakeDirtyTiles(std::vector<int> *tiles) {
+    tiles->clear();
+    tiles->swap(dirty_tiles_);
+    for (int tile : *tiles) {
+      tile_dirty_[tile] = 0;
+    }
+  }
+
+  /* Inclusive bounds of a tile in model cells */
+  void OccupancyMapper::GetTileBounds(int tile, ModelCoordinates *min, ModelCoordinates *max) {
+    int x = tile % tiles_wide_ * kTileSize;
+    int y = tile / tiles_wide_ * kTileSize;
+    *min = ModelCoordinates(x, y);
+    *max = ModelCoordinates(std::min(x + kTileSize, width_) - 1, std::min(y + kTileSize, height_) - 1);
+  }
+
+  /* Adds delta to the log-odds of a cell and updates the model when the cell changes state */
+  void OccupancyMapper::Update(int x, int y, signed char delta) {
+    std::size_t index = static_cast<std::size_t>(y) * width_ + x;
+    if (coverage_[index] == kStatic) {
+      return;
+    }
+    int value = std::max<int>(-kClamp, std::min<int>(kClamp, log_odds_[index] + delta));
+    log_odds_[index] = value;
+    if (!sensed_[index] && value > kOccupied) {
+      sensed_[index] = 1;
+      Stamp(x, y, true);
+    } else if (sensed_[index] && value < kFree) {
+      sensed_[index] = 0;
+      Stamp(x, y, false);
+    }
+  }
+
+  /*
+   * Adds or removes the grown disc around a sensed obstacle. Each cell counts
+   * the discs covering it and is an obstacle while that count is not zero.
+   */
+  void OccupancyMapper::Stamp(int x, int y, bool add) {
+    for (ModelCoordinates offset : growth_offsets_) {
+      int nx = x + offset.GetX();
+      int ny = y + offset.GetY();
+      if (nx < 0 || ny < 0 || nx >= width_ || ny >= height_) {
+        continue;
+      }
+      unsigned short &coverage = coverage_[static_cast<std::size_t>(ny) * width_ + nx];
+      if (coverage == kStatic) {
+        continue;
+      }
+      if (add) {
+        if (coverage++ == 0) {
+          model_->SetObstacle(ModelCoordinates(nx, ny));
+          MarkDirty(nx, ny);
+        }
+      } else if (--coverage == 0) {
+        model_->SetEmpty(ModelCoordinates(nx, ny));
+        MarkDirty(nx, ny);
+      }
+    }
+  }
+
+  void OccupancyMapper::MarkDirty(int x, int y) {
+    int tile = y / kTileSize * tiles_wide_ + x / kTileSize;
+    if (!tile_dirty_[tile]) {
+      tile_dirty_[tile] = 1;
+      dirty_tiles_.push_back(tile);
+    }
+  }
+} // namespace jlbot
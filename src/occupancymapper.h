@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   occupancymapper.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 14, 2017, 9:40 AM
+ */
+
+#ifndef OCCUPANCYMAPPER_H
+#define OCCUPANCYMAPPER_H
+
+#include <vector>
+#include "misc.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Fuses laser scans into a world model. Every beam is traced through the
+   * grid and lowers the log-odds of the cells it passes and raises the cell
+   * it ends in. A cell whose log-odds crosses the occupied threshold is
+   * written into the model grown by the obstacle growth radius, and removed
+   * again once it falls below the free threshold. Obstacles that were in the
+   * model before the first scan are never removed. Changed cells are
+   * collected per kTileSize x kTileSize tile for consumers to reprocess.
+   */
+  class OccupancyMapper {
+  public:
+    static const int kTileSize = 32;
+    OccupancyMapper(WorldModel *model, double obstacle_growth);
+    void Integrate(const LaserScan &scan);
+    bool HasChanges();
+    void TakeDirtyTiles(std::vector<int> *tiles);
+    void GetTileBounds(int tile, ModelCoordinates *min, ModelCoordinates *max);
+  private:
+    static const signed char kHit = 12;
+    static const signed char kMiss = -4;
+    static const signed char kClamp = 100;
+    static const signed char kOccupied = 40;
+    static const signed char kFree = 0;
+    static const unsigned short kStatic = 0xFFFF;
+    WorldModel *model_;
+    int width_;
+    int height_;
+    int tiles_wide_;
+    std::vector<signed char> log_odds_;
+    std::vector<unsigned char> sensed_;
+    std::vector<unsigned short> coverage_;
+    std::vector<ModelCoordinates> growth_offsets_;
+    std::vector<unsigned char> tile_dirty_;
+    std::vector<int> dirty_tiles_;
+    std::vector<double> cosines_;
+    std::vector<double> sines_;
+    void Update(int x, int y, signed char delta);
+    void Stamp(int x, int y, bool add);
+    void MarkDirty(int x, int y);
+  };
+} // namespace jlbot
+#endif /* OCCUPANCYMAPPER_H */
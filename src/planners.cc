@@ -24,132 +24,236 @@
  */
 
 #include "planners.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include "mapcache.h"
+#include "visitorder.h"
 
 namespace jlbot {
 
-  Navigator::Navigator(WorldCoordinates start, WorldCoordinates goal) : model_("hospital_section.pnm") {
-    model_.Save("0_scaled.pnm");
-    WorldModel *full_path_model = new WorldModel(model_);
-    WorldModel *relaxed_path_model = new WorldModel(model_);
-    GrowObstacles(4);
-    model_.Save("1_grow_obstacles.pnm");
+  const long Navigator::kUnreachable;
+
+  /*
+   * Loads the map; paths are planned later with PlanPath. Debug images are
+   * only written when a debug writer is given and enabled, the maps here
+   * and each planned path on the scaled map.
+   */
+  Navigator::Navigator(DebugArtifacts *debug, std::string planner) {
+    DebugArtifacts disabled(false);
+    debug_ = debug;
+    if (debug == NULL) {
+      debug = &disabled;
+    }
+    planner_ = Planner::Create(planner);
+    WorldModel scaled_model;
+    LoadMap("hospital_section.pnm", &scaled_model);
+    model_.BuildPyramid(kPyramidLevels);
+    mapper_.reset(new OccupancyMapper(&model_, kObstacleGrowth));
+    scaled_map_ = debug->SaveMap("0_scaled.pnm", &scaled_model);
+    debug->SaveMap("1_grow_obstacles.pnm", &model_);
+  }
+
+  /* The mapper writes sensed obstacles into the planning map */
+  OccupancyMapper *Navigator::GetMapper() {
+    return mapper_.get();
+  }
+
+  /*
+   * Brings the pyramid up to date with the tiles the mapper changed. Only
+   * the pyramid cells above changed tiles are recomputed. Returns true if
+   * the rest of trajectory, from the sample nearest position on, runs
+   * through a cell of those tiles that is now an obstacle; changes
+   * anywhere else leave the path as it is.
+   */
+  bool Navigator::UpdateMap(Trajectory *trajectory, WorldCoordinates position) {
+    std::vector<int> tiles;
+    mapper_->TakeDirtyTiles(&tiles);
+    std::vector<ModelCoordinates> mins;
+    std::vector<ModelCoordinates> maxes;
+    for (int tile : tiles) {
+      ModelCoordinates min;
+      ModelCoordinates max;
+      mapper_->GetTileBounds(tile, &min, &max);
+      model_.RefreshPyramid(min, max);
+      mins.push_back(min);
+      maxes.push_back(max);
+    }
+    double now = trajectory->GetNearestTime(position);
+    for (const Setpoint &sample : trajectory->GetSamples()) {
+      if (sample.time < now || !IsBlocked(sample.position)) {
+        continue;
+      }
+      ModelCoordinates cell = model_.WorldToModel(sample.position);
+      for (std::size_t i = 0; i < mins.size(); i++) {
+        if (cell.GetX() >= mins[i].GetX() && cell.GetX() <= maxes[i].GetX() && cell.GetY() >= mins[i].GetY() && cell.GetY() <= maxes[i].GetY()) {
+          std::cout << "New obstacles block the path." << std::endl;
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /* Plans again from start to the current goal, after UpdateMap found the path blocked */
+  bool Navigator::Replan(WorldCoordinates start) {
+    std::cout << "Replanning...." << std::endl;
+    return PlanPath(start, goal_);
+  }
+
+  /*
+   * Plans a new mission on the already loaded map. Planners may keep state
+   * between missions, such as distance fields of goals that were planned
+   * to before. The previous path is kept if the goal cannot be reached,
+   * which includes a start or goal off the map; the planners index the
+   * grid without bounds checks, so those never reach them.
+   */
+  bool Navigator::PlanPath(WorldCoordinates start, WorldCoordinates goal) {
     ModelCoordinates begin = model_.WorldToModel(start);
     ModelCoordinates end = model_.WorldToModel(goal);
-    std::deque<ModelCoordinates> temp_path = Wavefront(begin, end);
-    TracePath(temp_path, full_path_model);
-    full_path_model->Save("2_full_path.pnm");
+    if (!IsOnMap(begin) || !IsOnMap(end)) {
+      std::cout << "Goal is unreachable, " << (IsOnMap(begin) ? "the goal" : "the start") << " is off the map." << std::endl;
+      return false;
+    }
+    std::deque<ModelCoordinates> temp_path = Plan(begin, end);
+    if (temp_path.empty()) {
+      return false;
+    }
+    if (scaled_map_) {
+      debug_->SavePath("2_full_path.pnm", scaled_map_, temp_path);
+    }
     temp_path = RelaxPath(temp_path);
-    TracePath(temp_path, relaxed_path_model);
-    relaxed_path_model->Save("3_relaxed_path.pnm");
+    if (scaled_map_) {
+      debug_->SavePath("3_relaxed_path.pnm", scaled_map_, temp_path);
+    }
+    goal_ = goal;
     path_ = ModelToWorld(temp_path);
     path_.push_front(start);
     path_.push_back(goal);
+    return true;
   }
 
-  void Navigator::GrowObstacles(int thickness) {
-    std::cout << "Growing obstacles by " << thickness << " pixels...." << std::endl;
-    static const int kNewObstacle = -3;
-    for (int i = 0; i < thickness; i++) {
-      for (int y = 0; y < model_.GetHeight(); y++) {
-        for (int x = 0; x < model_.GetWidth(); x++) {
-          ModelCoordinates current(x, y);
-          if (model_.IsObstacle(current)) {
-            for (ModelCoordinates neighbor : model_.GetNeighbors(current)) {
-              if (model_.IsEmpty(neighbor)) {
-                model_.SetValue(neighbor, kNewObstacle);
-              }
-            }
-          }
+  /*
+   * Orders a round of goals with the cheapest visiting order from start,
+   * costing every pair of stops along the roadmap with GetRouteCost.
+   * Goals that cannot be reached from start are left out. Returns the
+   * goals in visiting order without planning any of them, so the round is
+   * driven one leg at a time with PlanPath.
+   */
+  std::vector<WorldCoordinates> Navigator::PlanRound(WorldCoordinates start, std::vector<WorldCoordinates> goals) {
+    std::cout << "Ordering a round of " << goals.size() << " goals...." << std::endl;
+    std::vector<WorldCoordinates> stops(1, start);
+    stops.insert(stops.end(), goals.begin(), goals.end());
+    std::vector<std::vector<long> > costs(stops.size(), std::vector<long>(stops.size(), 0));
+    for (std::size_t from = 0; from < stops.size(); from++) {
+      for (std::size_t to = 0; to < stops.size(); to++) {
+        if (from != to) {
+          double cost = GetRouteCost(stops[from], stops[to]);
+          costs[from][to] = cost == Roadmap::kNoRoute ? kUnreachable : std::lround(cost);
         }
       }
-      for (int y = 0; y < model_.GetHeight(); y++) {
-        for (int x = 0; x < model_.GetWidth(); x++) {
-          ModelCoordinates current(x, y);
-          if (model_.GetValue(current) == kNewObstacle) {
-            model_.SetObstacle(current);
-          }
-        }
+    }
+    std::vector<int> reachable(1, 0);
+    for (std::size_t stop = 1; stop < stops.size(); stop++) {
+      if (costs[0][stop] == kUnreachable) {
+        std::cout << "Goal " << goals[stop - 1].ToString() << " is unreachable." << std::endl;
+      } else {
+        reachable.push_back(stop);
       }
     }
+    std::vector<std::vector<long> > reachable_costs(reachable.size(), std::vector<long>(reachable.size()));
+    for (std::size_t i = 0; i < reachable.size(); i++) {
+      for (std::size_t j = 0; j < reachable.size(); j++) {
+        reachable_costs[i][j] = costs[reachable[i]][reachable[j]];
+      }
+    }
+    VisitOrder order(reachable_costs);
+    std::vector<int> route = order.Solve();
+    std::cout << "Round takes " << order.GetCost(route) << " cells." << std::endl;
+    std::vector<WorldCoordinates> ordered;
+    for (std::size_t leg = 1; leg < route.size(); leg++) {
+      ordered.push_back(goals[reachable[route[leg]] - 1]);
+    }
+    return ordered;
   }
 
-  int Navigator::PropagateWave(ModelCoordinates start, ModelCoordinates goal) {
-    std::cout << "Propagating wave...." << std::endl;
-    int count = 0;
-    model_.SetValue(goal, count);
-    if (start.Equals(goal)) {
-      return count;
-    }
-    std::deque<ModelCoordinates> fringe;
-    fringe.push_back(goal);
-    while (!fringe.empty()) {
-      count++;
-      std::deque<ModelCoordinates> new_fringe;
-      for (ModelCoordinates fringe_element : fringe) {
-        std::deque<ModelCoordinates> neighbors = model_.GetNeighbors(fringe_element);
-        for (ModelCoordinates neighbor : neighbors) {
-          if (model_.IsEmpty(neighbor)) {
-            model_.SetValue(neighbor, count);
-            if (start.Equals(fringe_element)) {
-              return count;
-            }
-            new_fringe.push_back(neighbor);
-          }
-        }
-      }
-      fringe = new_fringe;
+  /*
+   * Cost, in cells, of a route from start to goal along the roadmap, or
+   * Roadmap::kNoRoute. Meant for answering many cost queries quickly; the
+   * roadmap is built on the first query and again after the map changes.
+   * Like the planners, it starts from the nearest free cell; ends off the
+   * map have no route.
+   */
+  double Navigator::GetRouteCost(WorldCoordinates start, WorldCoordinates goal) {
+    ModelCoordinates from = FindFreeCell(model_.WorldToModel(start));
+    ModelCoordinates to = model_.WorldToModel(goal);
+    if (!IsOnMap(from) || !IsOnMap(to)) {
+      return Roadmap::kNoRoute;
     }
-    return -1;
+    if (!roadmap_.IsCurrent(&model_)) {
+      roadmap_.Build(&model_);
+    }
+    return roadmap_.GetCost(from, to);
   }
 
-  std::deque<ModelCoordinates> Navigator::GetStraightLinePath(ModelCoordinates a, ModelCoordinates b) {
-    std::deque<ModelCoordinates> path;
-    if (a.GetX() == b.GetX()) {
-      int y_min = std::min(a.GetY(), b.GetY());
-      int y_max = std::max(a.GetY(), b.GetY());
-      for (int y = y_min; y <= y_max; y++) {
-        path.push_back(ModelCoordinates(a.GetX(), y));
-      }
-    } else {
-      double x1 = a.GetX();
-      double x2 = b.GetX();
-      double y1 = a.GetY();
-      double y2 = b.GetY();
-      double m = (y1 - y2) / (x1 - x2);
-      double b = -x1 * m + y1;
-      double x_min = std::min(x1, x2);
-      double x_max = std::max(x1, x2);
-      for (int x = x_min; x <= x_max; x++) {
-        double y = m * x + b;
-        y = std::round(y);
-        path.push_back(ModelCoordinates(x, y));
+  /*
+   * Plans robots sharing this map so they never come within each other's
+   * footprint, highest priority first. Each path has one position per time
+   * step, so a repeated position means waiting; robots that could not be
+   * planned get an empty path. Starts and goals are moved to the nearest
+   * free cell, as PlanPath's planners start, unless they are off the map;
+   * those robots are not planned.
+   */
+  std::vector<std::deque<WorldCoordinates> > Navigator::PlanFleet(const std::vector<WorldCoordinates> &starts, const std::vector<WorldCoordinates> &goals, const std::vector<int> &priorities) {
+    std::vector<FleetTask> tasks;
+    for (std::size_t robot = 0; robot < starts.size(); robot++) {
+      ModelCoordinates start = model_.WorldToModel(starts[robot]);
+      ModelCoordinates goal = model_.WorldToModel(goals[robot]);
+      if (IsOnMap(start) && IsOnMap(goal)) {
+        start = FindFreeCell(start);
+        goal = FindFreeCell(goal);
       }
+      FleetTask task = {start, goal, priorities[robot]};
+      tasks.push_back(task);
     }
-    return path;
+    std::vector<std::deque<ModelCoordinates> > paths = fleet_planner_.Plan(&model_, tasks);
+    std::vector<std::deque<WorldCoordinates> > world_paths;
+    for (std::deque<ModelCoordinates> &path : paths) {
+      world_paths.push_back(ModelToWorld(path));
+    }
+    return world_paths;
   }
 
-  bool Navigator::IsClear(std::deque<ModelCoordinates> path) {
-    for (ModelCoordinates i : path) {
-      if (model_.IsObstacle(i)) {
-        return false;
-      }
+  /* Loads the scaled and grown maps from the map cache, building and caching them if needed */
+  void Navigator::LoadMap(std::string filename, WorldModel *scaled_model) {
+    MapCache cache(filename, kObstacleGrowth);
+    if (cache.Load(scaled_model, &model_)) {
+      return;
     }
-    return true;
+    model_ = WorldModel(filename);
+    model_.ComputeClearance();
+    *scaled_model = model_;
+    model_.GrowObstacles(kObstacleGrowth);
+    cache.Store(scaled_model, &model_);
   }
 
+  /*
+   * Greedily replaces runs of waypoints by straight shortcuts. Any-angle
+   * paths are relaxed too; their turning points hug the rounded edges of
+   * the grown obstacles and many of them can still be skipped.
+   */
   std::deque<ModelCoordinates> Navigator::RelaxPath(std::deque<ModelCoordinates> path) {
     std::cout << "Relaxing path...." << std::endl;
     if (path.size() < 3) {
       return path;
     }
     int last = path.size() - 1;
+    float comfort = planner_->GetComfortClearance();
     std::deque<ModelCoordinates> relaxed_path;
     relaxed_path.push_back(path[0]);
     for (int reference = 0, clear = 1, test = 1; test <= last - 1;) {
-      std::deque<ModelCoordinates> straight_line = GetStraightLinePath(path[reference], path[clear]);
-      if (IsClear(straight_line)) {
+      if (model_.IsLineClear(path[reference], path[clear]) && IsComfortable(path, reference, clear, comfort)) {
         clear = test;
         test++;
       } else {
@@ -161,28 +265,16 @@ namespace jlbot {
     return relaxed_path;
   }
 
-  std::deque<ModelCoordinates> Navigator::ExtractPath(ModelCoordinates start, int count) {
-    ModelCoordinates current = start;
-    std::deque<ModelCoordinates> path;
-    path.push_back(start);
-    for (int i = count; i > 0; i--) {
-      for (ModelCoordinates neighbor : model_.GetNeighbors(current)) {
-        if (model_.GetValue(neighbor) == i - 1) {
-          current = neighbor;
-          path.push_back(neighbor);
-          break;
-        }
-      }
+  /* True if the shortcut from path[from] to path[to] keeps the clearance the planner asked for */
+  bool Navigator::IsComfortable(const std::deque<ModelCoordinates> &path, int from, int to, float comfort) {
+    if (comfort <= 0) {
+      return true;
     }
-    std::cout << "Wavefront generated a path with " << path.size() << " waypoints." << std::endl;
-    return path;
-  }
-
-  void Navigator::TracePath(std::deque<ModelCoordinates> path, WorldModel *model) {
-    for (ModelCoordinates i : path) {
-      model->SetPath(i);
+    float required = comfort;
+    for (int i = from; i <= to; i++) {
+      required = std::min(required, model_.GetClearance(path[i]));
     }
-    std::cout << "Printed path to the world model." << std::endl;
+    return model_.GetLineClearance(path[from], path[to]) >= required;
   }
 
   std::deque<WorldCoordinates> Navigator::ModelToWorld(std::deque<ModelCoordinates> model_path) {
@@ -193,42 +285,87 @@ namespace jlbot {
     return world_path;
   }
 
-  std::deque<ModelCoordinates> Navigator::Wavefront(ModelCoordinates start, ModelCoordinates goal) {
-    int count = PropagateWave(start, goal);
-    std::deque<ModelCoordinates> path;
-    if (count == -1) {
+  /*
+   * A robot that stopped at a goal near a wall may be inside the grown
+   * obstacles, so planning starts from the nearest free cell instead.
+   * Returns an empty path if the goal is unreachable; the current path is
+   * left to the caller.
+   */
+  std::deque<ModelCoordinates> Navigator::Plan(ModelCoordinates start, ModelCoordinates goal) {
+    std::cout << "Planning with " << planner_->GetName() << "...." << std::endl;
+    std::deque<ModelCoordinates> path = planner_->Plan(&model_, FindFreeCell(start), goal);
+    if (path.empty()) {
       std::cout << "Goal is unreachable." << std::endl;
-      has_path_ = false;
     } else {
-      std::cout << "Found a path to the goal." << std::endl;
-      has_path_ = true;
-      path = ExtractPath(start, count);
+      std::cout << "Found a path to the goal with " << path.size() << " waypoints." << std::endl;
     }
     return path;
   }
 
-  Pilot Navigator::GetPilot() {
-    return Pilot(path_);
-  }
-
-  bool Navigator::HasPath() {
-    return has_path_;
+  /*
+   * Smooths the current path into a timed trajectory. The spline may bow
+   * out from the straight segments of the path; wherever it enters an
+   * obstacle cell, the segment's midpoint is added as another waypoint to
+   * pull the spline back toward the segment.
+   */
+  Trajectory Navigator::GetTrajectory(double initial_speed) {
+    std::deque<WorldCoordinates> waypoints = path_;
+    for (int refinement = 0;; refinement++) {
+      Trajectory trajectory(waypoints, initial_speed);
+      int segment = FindCollision(&trajectory);
+      if (segment < 0 || refinement == kMaxSmoothingRefinements) {
+        std::cout << "Trajectory takes " << trajectory.GetDuration() << " seconds." << std::endl;
+        return trajectory;
+      }
+      waypoints = trajectory.GetWaypoints();
+      WorldCoordinates from = waypoints[segment];
+      WorldCoordinates to = waypoints[segment + 1];
+      WorldCoordinates middle((from.GetX() + to.GetX()) / 2, (from.GetY() + to.GetY()) / 2);
+      waypoints.insert(waypoints.begin() + segment + 1, middle);
+    }
   }
 
-  Pilot::Pilot(std::deque<WorldCoordinates> path) {
-    path_ = path;
-    current_objective_ = 0;
+  /*
+   * Segment of the first trajectory sample in an obstacle cell, or -1.
+   * Segments that start or end in an obstacle cell, such as one ending at
+   * a goal inside the grown obstacles, are not checked.
+   */
+  int Navigator::FindCollision(Trajectory *trajectory) {
+    const std::deque<WorldCoordinates> &waypoints = trajectory->GetWaypoints();
+    for (const Setpoint &sample : trajectory->GetSamples()) {
+      if (IsBlocked(sample.position) && !IsBlocked(waypoints[sample.segment]) && !IsBlocked(waypoints[sample.segment + 1])) {
+        return sample.segment;
+      }
+    }
+    return -1;
   }
 
-  void Pilot::ReachedObjective() {
-    current_objective_++;
+  /* Nearest cell to center, by rings of growing radius, that is not an obstacle; center itself if none is close */
+  ModelCoordinates Navigator::FindFreeCell(ModelCoordinates center) {
+    for (int radius = 0; radius <= 2 * kObstacleGrowth; radius++) {
+      for (int y = center.GetY() - radius; y <= center.GetY() + radius; y++) {
+        for (int x = center.GetX() - radius; x <= center.GetX() + radius; x++) {
+          ModelCoordinates cell(x, y);
+          bool on_ring = std::abs(x - center.GetX()) == radius || std::abs(y - center.GetY()) == radius;
+          if (on_ring && x >= 0 && y >= 0 && x < model_.GetWidth() && y < model_.GetHeight() && !model_.IsObstacle(cell)) {
+            return cell;
+          }
+        }
+      }
+    }
+    return center;
   }
 
-  bool Pilot::HasObjectives() {
-    return path_.size() > current_objective_;
+  /* Positions off the map count as blocked */
+  bool Navigator::IsBlocked(WorldCoordinates position) {
+    ModelCoordinates cell = model_.WorldToModel(position);
+    if (!IsOnMap(cell)) {
+      return true;
+    }
+    return model_.IsObstacle(cell);
   }
 
-  WorldCoordinates Pilot::GetNextObjective() {
-    return path_[current_objective_];
+  bool Navigator::IsOnMap(ModelCoordinates cell) {
+    return cell.GetX() >= 0 && cell.GetY() >= 0 && cell.GetX() < model_.GetWidth() && cell.GetY() < model_.GetHeight();
   }
 } // namespace jlbot
\ No newline at end of file
@@ -27,41 +27,54 @@
 #define PLANNERS_H
 
 #include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cooperativeplanner.h"
+#include "debugartifacts.h"
 #include "misc.h"
+#include "occupancymapper.h"
+#include "roadmap.h"
+#include "searchplanners.h"
+#include "trajectory.h"
 #include "worldmodel.h"
 
 namespace jlbot {
 
-  class Pilot {
-  public:
-    Pilot();
-    Pilot(std::deque<WorldCoordinates> path);
-    void ReachedObjective();
-    bool HasObjectives();
-    WorldCoordinates GetNextObjective();
-  private:
-    std::deque<WorldCoordinates> path_;
-    int current_objective_;
-  };
-
   class Navigator {
   public:
-    void TracePath(std::deque<ModelCoordinates> path, WorldModel *world_model);
-    Pilot GetPilot();
-    bool HasPath();
-    Navigator(WorldCoordinates start, WorldCoordinates goal);
+    Trajectory GetTrajectory(double initial_speed);
+    Navigator(DebugArtifacts *debug = NULL, std::string planner = "wavefront");
+    OccupancyMapper *GetMapper();
+    bool PlanPath(WorldCoordinates start, WorldCoordinates goal);
+    std::vector<WorldCoordinates> PlanRound(WorldCoordinates start, std::vector<WorldCoordinates> goals);
+    double GetRouteCost(WorldCoordinates start, WorldCoordinates goal);
+    std::vector<std::deque<WorldCoordinates> > PlanFleet(const std::vector<WorldCoordinates> &starts, const std::vector<WorldCoordinates> &goals, const std::vector<int> &priorities);
+    bool UpdateMap(Trajectory *trajectory, WorldCoordinates position);
+    bool Replan(WorldCoordinates start);
   private:
+    static const int kObstacleGrowth = 4;
+    static const int kPyramidLevels = 5;
+    static const int kMaxSmoothingRefinements = 8;
+    static const long kUnreachable = -1;
     WorldModel model_;
-    bool has_path_;
+    std::unique_ptr<Planner> planner_;
+    std::unique_ptr<OccupancyMapper> mapper_;
+    Roadmap roadmap_;
+    CooperativePlanner fleet_planner_;
+    DebugArtifacts *debug_;
+    std::shared_ptr<DebugArtifacts::Snapshot> scaled_map_;
+    WorldCoordinates goal_;
     std::deque<WorldCoordinates> path_;
-    void GrowObstacles(int thickness);
-    std::deque<ModelCoordinates> Wavefront(ModelCoordinates start, ModelCoordinates goal);
-    int PropagateWave(ModelCoordinates start, ModelCoordinates goal);
-    std::deque<ModelCoordinates> ExtractPath(ModelCoordinates start, int count);
+    void LoadMap(std::string filename, WorldModel *scaled_model);
+    std::deque<ModelCoordinates> Plan(ModelCoordinates start, ModelCoordinates goal);
     std::deque<ModelCoordinates> RelaxPath(std::deque<ModelCoordinates> path);
-    std::deque<ModelCoordinates> GetStraightLinePath(ModelCoordinates a, ModelCoordinates b);
-    bool IsClear(std::deque<ModelCoordinates> path);
+    bool IsComfortable(const std::deque<ModelCoordinates> &path, int from, int to, float comfort);
     std::deque<WorldCoordinates> ModelToWorld(std::deque<ModelCoordinates> model_path);
+    int FindCollision(Trajectory *trajectory);
+    bool IsBlocked(WorldCoordinates position);
+    bool IsOnMap(ModelCoordinates cell);
+    ModelCoordinates FindFreeCell(ModelCoordinates center);
   };
 } // namespace jlbot
 #endif /* PLANNERS_H */
@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   roadmap.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 29, 2017, 3:05 PM
+ */
+
+#include "roadmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+
+namespace jlbot {
+
+  constexpr double Roadmap::kNoRoute;
+  const int Roadmap::kWitnessSettles;
+  const int Roadmap::kMaxDirectCells;
+  constexpr double Roadmap::kDirectRange;
+  constexpr double Roadmap::kMaxChainDetour;
+
+  Roadmap::Roadmap() : built_(false), revision_(0), shortcuts_(0), cell_search_(0), node_search_(0) {
+  }
+
+  /* Rebuilds the skeleton, the graph and its hierarchy from the model's current cells */
+  void Roadmap::Build(WorldModel *model) {
+    std::cout << "Building roadmap...." << std::endl;
+    revision_ = model->GetRevision();
+    width_ = model->GetWidth();
+    height_ = model->GetHeight();
+    stride_ = width_ + 2;
+    /* Clockwise from north, so neighbors next to each other in the ring touch */
+    int ring[8] = {-stride_, -stride_ + 1, 1, stride_ + 1, stride_, stride_ - 1, -1, -stride_ - 1};
+    std::copy(ring, ring + 8, ring_);
+    for (int direction = 0; direction < 8; direction++) {
+      costs_[direction] = direction % 2 == 0 ? 1 : std::sqrt(2.0);
+    }
+    std::size_t size = static_cast<std::size_t>(stride_) * (height_ + 2);
+    free_.assign(size, 0);
+    const unsigned char *cells = model->GetCells();
+    for (int y = 0; y < height_; y++) {
+      for (int x = 0; x < width_; x++) {
+        free_[Index(ModelCoordinates(x, y))] = cells[static_cast<std::size_t>(y) * width_ + x] != WorldModel::kObstacle;
+      }
+    }
+    cell_stamps_.assign(size, 0);
+    cell_costs_.assign(size, 0);
+    cell_search_ = 0;
+    skeleton_ = free_;
+    Thin();
+    TraceEdges();
+    LabelChains();
+    ComputeFeet();
+    Contract();
+    BuildUpwardGraph();
+    for (int side = 0; side < 2; side++) {
+      node_stamps_[side].assign(nodes_.size(), 0);
+      node_costs_[side].assign(nodes_.size(), 0);
+    }
+    node_search_ = 0;
+    built_ = true;
+    std::cout << "Roadmap has " << nodes_.size() << " nodes and " << shortcuts_ << " shortcuts." << std::endl;
+  }
+
+  /* False if the roadmap was never built or the model has changed since */
+  bool Roadmap::IsCurrent(WorldModel *model) {
+    return built_ && revision_ == model->GetRevision();
+  }
+
+  /* Cost of a route from start to goal, or kNoRoute if the roadmap does not join them */
+  double Roadmap::GetCost(ModelCoordinates start, ModelCoordinates goal) {
+    int source = Index(start);
+    int target = Index(goal);
+    if (Estimate(source, target) <= kDirectRange) {
+      double direct = SearchDirect(source, target);
+      if (direct < std::numeric_limits<double>::infinity()) {
+        return direct;
+      }
+    }
+    GetSeeds(source, &start_seeds_);
+    GetSeeds(target, &goal_seeds_);
+    double best = SearchUpward(start_seeds_, goal_seeds_, JoinAlongChain(source, target));
+    return best < std::numeric_limits<double>::infinity() ? best : kNoRoute;
+  }
+
+  int Roadmap::GetNodeCount() {
+    return nodes_.size();
+  }
+
+  int Roadmap::GetShortcutCount() {
+    return shortcuts_;
+  }
+
+  /*
+   * Zhang and Suen thinning ("A Fast Parallel Algorithm for Thinning
+   * Digital Patterns"). Each pass peels removable cells off one side of
+   * the free space at once, and passes alternate until nothing changes.
+   */
+  void Roadmap::Thin() {
+    std::vector<int> removed;
+    for (int pass = 0, unchanged = 0; unchanged < 2; pass = 1 - pass) {
+      removed.clear();
+      for (int y = 0; y < height_; y++) {
+        int cell = Index(ModelCoordinates(0, y));
+        for (int x = 0; x < width_; x++, cell++) {
+          if (skeleton_[cell] && IsRemovable(cell, pass)) {
+            removed.push_back(cell);
+          }
+        }
+      }
+      for (int cell : removed) {
+        skeleton_[cell] = 0;
+      }
+      unchanged = removed.empty() ? unchanged + 1 : 0;
+    }
+  }
+
+  /* A cell is removable if it lies on the boundary, is not an end, and removing it keeps its neighbors joined */
+  bool Roadmap::IsRemovable(int cell, int pass) {
+    int neighbors = 0;
+    for (int offset : ring_) {
+      neighbors += skeleton_[cell + offset];
+    }
+    if (neighbors < 2 || neighbors > 6 || CountCrossings(cell) != 1) {
+      return false;
+    }
+    bool north = skeleton_[cell + ring_[0]];
+    bool east = skeleton_[cell + ring_[2]];
+    bool south = skeleton_[cell + ring_[4]];
+    bool west = skeleton_[cell + ring_[6]];
+    if (pass == 0) {
+      return !(north && east && south) && !(east && south && west);
+    }
+    return !(north && east && west) && !(north && south && west);
+  }
+
+  /* Number of steps from a skeleton cell to a free cell going around the ring of neighbors */
+  int Roadmap::CountCrossings(int cell) {
+    int crossings = 0;
+    for (int direction = 0; direction < 8; direction++) {
+      if (!skeleton_[cell + ring_[direction]] && skeleton_[cell + ring_[(direction + 1) % 8]]) {
+        crossings++;
+      }
+    }
+    return crossings;
+  }
+
+  /*
+   * Skeleton cells that do not continue a line in exactly one direction
+   * on each side are nodes. Edges are found by a search from every node
+   * along the skeleton that stops at other nodes; each skeleton cell is
+   * attached to the nearest nodes the searches reached it from. Loops of
+   * skeleton with no node on them get one.
+   */
+  void Roadmap::TraceEdges() {
+    node_of_cell_.assign(skeleton_.size(), -1);
+    nodes_.clear();
+    arcs_.clear();
+    for (std::size_t cell = 0; cell < skeleton_.size(); cell++) {
+      if (skeleton_[cell] && CountCrossings(cell) != 2) {
+        node_of_cell_[cell] = nodes_.size();
+        nodes_.push_back(cell);
+      }
+    }
+    arcs_.resize(nodes_.size());
+    attached_nodes_.assign(2 * skeleton_.size(), -1);
+    attached_costs_.assign(2 * skeleton_.size(), 0);
+    for (std::size_t node = 0; node < nodes_.size(); node++) {
+      TraceFrom(node);
+    }
+    for (std::size_t cell = 0; cell < skeleton_.size(); cell++) {
+      if (skeleton_[cell] && attached_nodes_[2 * cell] < 0) {
+        node_of_cell_[cell] = nodes_.size();
+        nodes_.push_back(cell);
+        arcs_.resize(nodes_.size());
+        TraceFrom(nodes_.size() - 1);
+      }
+    }
+  }
+
+  void Roadmap::TraceFrom(int node) {
+    std::vector<std::pair<double, int> > &heap = heaps_[0];
+    std::greater<std::pair<double, int> > later;
+    int source = nodes_[node];
+    cell_search_++;
+    cell_stamps_[source] = cell_search_;
+    cell_costs_[source] = 0;
+    heap.assign(1, std::make_pair(0.0, source));
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      double cost = heap.back().first;
+      int cell = heap.back().second;
+      heap.pop_back();
+      if (cost > cell_costs_[cell]) {
+        continue;
+      }
+      if (cell != source && node_of_cell_[cell] >= 0) {
+        AddArc(node, node_of_cell_[cell], cost);
+        continue;
+      }
+      Attach(cell, node, cost);
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + ring_[direction];
+        double next = cost + costs_[direction];
+        if (skeleton_[neighbor] && (cell_stamps_[neighbor] != cell_search_ || next < cell_costs_[neighbor])) {
+          cell_stamps_[neighbor] = cell_search_;
+          cell_costs_[neighbor] = next;
+          heap.push_back(std::make_pair(next, neighbor));
+          std::push_heap(heap.begin(), heap.end(), later);
+        }
+      }
+    }
+  }
+
+  /* Keeps the two nearest nodes of each skeleton cell */
+  void Roadmap::Attach(int cell, int node, double cost) {
+    int *attached = &attached_nodes_[2 * cell];
+    double *costs = &attached_costs_[2 * cell];
+    int slot = costs[0] > costs[1] ? 0 : 1;
+    if (attached[0] < 0 || attached[0] == node) {
+      slot = 0;
+    } else if (attached[1] < 0 || attached[1] == node) {
+      slot = 1;
+    }
+    if (attached[slot] < 0 || cost < costs[slot]) {
+      attached[slot] = node;
+      costs[slot] = cost;
+    }
+  }
+
+  /* Adds an edge both ways, or lowers its cost if it is already there */
+  void Roadmap::AddArc(int from, int to, double cost) {
+    int ends[2] = {from, to};
+    for (int end = 0; end < 2; end++) {
+      std::vector<Arc> &arcs = arcs_[ends[end]];
+      int other = ends[1 - end];
+      std::vector<Arc>::iterator arc = std::find_if(arcs.begin(), arcs.end(), [other](const Arc & a) {
+        return a.to == other;
+      });
+      if (arc == arcs.end()) {
+        Arc added = {other, cost};
+        arcs.push_back(added);
+      } else {
+        arc->cost = std::min(arc->cost, cost);
+      }
+    }
+  }
+
+  /*
+   * Contracts nodes in order of edge difference, the shortcuts a node
+   * needs less the edges it removes, plus how many of its neighbors are
+   * already contracted so contraction spreads evenly. Priorities are
+   * recomputed lazily when a node reaches the front of the queue.
+   */
+  void Roadmap::Contract() {
+    int count = nodes_.size();
+    std::vector<bool> contracted(count, false);
+    std::vector<int> contracted_neighbors(count, 0);
+    ranks_.assign(count, 0);
+    shortcuts_ = 0;
+    std::function<int(int)> priority = [&](int node) {
+      int degree = 0;
+      for (const Arc &arc : arcs_[node]) {
+        degree += !contracted[arc.to];
+      }
+      return ContractNode(node, true, &contracted) - degree + contracted_neighbors[node];
+    };
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >, std::greater<std::pair<int, int> > > queue;
+    for (int node = 0; node < count; node++) {
+      queue.push(std::make_pair(priority(node), node));
+    }
+    for (int rank = 0; !queue.empty();) {
+      int node = queue.top().second;
+      queue.pop();
+      int current = priority(node);
+      if (!queue.empty() && current > queue.top().first) {
+        queue.push(std::make_pair(current, node));
+        continue;
+      }
+      shortcuts_ += ContractNode(node, false, &contracted);
+      contracted[node] = true;
+      ranks_[node] = rank++;
+      for (const Arc &arc : arcs_[node]) {
+        contracted_neighbors[arc.to]++;
+      }
+    }
+  }
+
+  /*
+   * Counts, and unless simulating adds, the shortcuts needed between the
+   * uncontracted neighbors of node to keep their distances once node is
+   * gone. A shortcut is skipped when a bounded witness search finds
+   * another path no longer than the one through node.
+   */
+  int Roadmap::ContractNode(int node, bool simulate, std::vector<bool> *contracted) {
+    std::vector<Arc> neighbors;
+    for (const Arc &arc : arcs_[node]) {
+      if (!(*contracted)[arc.to]) {
+        neighbors.push_back(arc);
+      }
+    }
+    std::vector<std::pair<double, int> > &heap = heaps_[0];
+    std::greater<std::pair<double, int> > later;
+    std::vector<unsigned int> &stamps = node_stamps_[0];
+    std::vector<double> &costs = node_costs_[0];
+    stamps.resize(nodes_.size(), 0);
+    costs.resize(nodes_.size(), 0);
+    int added = 0;
+    for (std::size_t i = 0; i + 1 < neighbors.size(); i++) {
+      double limit = 0;
+      for (std::size_t j = i + 1; j < neighbors.size(); j++) {
+        limit = std::max(limit, neighbors[i].cost + neighbors[j].cost);
+      }
+      node_search_++;
+      stamps[neighbors[i].to] = node_search_;
+      costs[neighbors[i].to] = 0;
+      heap.assign(1, std::make_pair(0.0, neighbors[i].to));
+      for (int settled = 0; !heap.empty() && settled < kWitnessSettles; settled++) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        double cost = heap.back().first;
+        int current = heap.back().second;
+        heap.pop_back();
+        if (cost > costs[current]) {
+          continue;
+        }
+        if (cost > limit) {
+          break;
+        }
+        for (const Arc &arc : arcs_[current]) {
+          double next = cost + arc.cost;
+          if (arc.to != node && !(*contracted)[arc.to] && (stamps[arc.to] != node_search_ || next < costs[arc.to])) {
+            stamps[arc.to] = node_search_;
+            costs[arc.to] = next;
+            heap.push_back(std::make_pair(next, arc.to));
+            std::push_heap(heap.begin(), heap.end(), later);
+          }
+        }
+      }
+      for (std::size_t j = i + 1; j < neighbors.size(); j++) {
+        double through = neighbors[i].cost + neighbors[j].cost;
+        int other = neighbors[j].to;
+        if (stamps[other] != node_search_ || costs[other] > through) {
+          added++;
+          if (!simulate) {
+            AddArc(neighbors[i].to, other, through);
+          }
+        }
+      }
+    }
+    return added;
+  }
+
+  /* Keeps only the edges toward higher ranked nodes, packed by node */
+  void Roadmap::BuildUpwardGraph() {
+    int count = nodes_.size();
+    up_begin_.assign(count + 1, 0);
+    for (int node = 0; node < count; node++) {
+      for (const Arc &arc : arcs_[node]) {
+        up_begin_[node + 1] += ranks_[arc.to] > ranks_[node];
+      }
+    }
+    for (int node = 0; node < count; node++) {
+      up_begin_[node + 1] += up_begin_[node];
+    }
+    up_arcs_.resize(up_begin_[count]);
+    for (int node = 0; node < count; node++) {
+      int next = up_begin_[node];
+      for (const Arc &arc : arcs_[node]) {
+        if (ranks_[arc.to] > ranks_[node]) {
+          up_arcs_[next++] = arc;
+        }
+      }
+    }
+    std::vector<std::vector<Arc> >().swap(arcs_);
+  }
+
+  /*
+   * Gives every run of skeleton cells between nodes its own label, and
+   * finds the length of each run between two different nodes
+   */
+  void Roadmap::LabelChains() {
+    const double kInfinity = std::numeric_limits<double>::infinity();
+    chain_of_cell_.assign(skeleton_.size(), -1);
+    chain_lengths_.clear();
+    std::vector<int> stack;
+    int chains = 0;
+    for (std::size_t first = 0; first < skeleton_.size(); first++) {
+      if (!skeleton_[first] || node_of_cell_[first] >= 0 || chain_of_cell_[first] >= 0) {
+        continue;
+      }
+      chain_of_cell_[first] = chains;
+      chain_lengths_.push_back(kInfinity);
+      stack.assign(1, first);
+      while (!stack.empty()) {
+        int cell = stack.back();
+        stack.pop_back();
+        if (attached_nodes_[2 * cell + 1] >= 0) {
+          chain_lengths_[chains] = std::min(chain_lengths_[chains], attached_costs_[2 * cell] + attached_costs_[2 * cell + 1]);
+        }
+        for (int offset : ring_) {
+          int neighbor = cell + offset;
+          if (skeleton_[neighbor] && node_of_cell_[neighbor] < 0 && chain_of_cell_[neighbor] < 0) {
+            chain_of_cell_[neighbor] = chains;
+            stack.push_back(neighbor);
+          }
+        }
+      }
+      chains++;
+    }
+  }
+
+  /*
+   * Grid search outward from every skeleton cell at once, giving each cell
+   * its nearest skeleton cell and the cost to reach it. Obstacle cells are
+   * given a foot but not searched through, so starts inside the grown
+   * obstacles can still be joined.
+   */
+  void Roadmap::ComputeFeet() {
+    std::vector<std::pair<double, int> > &heap = heaps_[0];
+    std::greater<std::pair<double, int> > later;
+    feet_.assign(skeleton_.size(), -1);
+    foot_costs_.assign(skeleton_.size(), 0);
+    heap.clear();
+    for (std::size_t cell = 0; cell < skeleton_.size(); cell++) {
+      if (skeleton_[cell]) {
+        feet_[cell] = cell;
+        heap.push_back(std::make_pair(0.0, static_cast<int>(cell)));
+      }
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+    int first = Index(ModelCoordinates(0, 0));
+    int last = Index(ModelCoordinates(width_ - 1, height_ - 1));
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      double cost = heap.back().first;
+      int cell = heap.back().second;
+      heap.pop_back();
+      if (cost > foot_costs_[cell] || !free_[cell]) {
+        continue;
+      }
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + ring_[direction];
+        double next = cost + costs_[direction];
+        bool inside = neighbor >= first && neighbor <= last && neighbor % stride_ != 0 && neighbor % stride_ != stride_ - 1;
+        if (inside && (feet_[neighbor] < 0 || next < foot_costs_[neighbor])) {
+          feet_[neighbor] = feet_[cell];
+          foot_costs_[neighbor] = next;
+          heap.push_back(std::make_pair(next, neighbor));
+          std::push_heap(heap.begin(), heap.end(), later);
+        }
+      }
+    }
+  }
+
+  /*
+   * A* from one cell toward target over at most kMaxDirectCells cells,
+   * which answers queries between nearby cells better than the skeleton.
+   * The first cell and target may be obstacles.
+   */
+  double Roadmap::SearchDirect(int from, int target) {
+    const double kInfinity = std::numeric_limits<double>::infinity();
+    std::vector<std::pair<double, int> > &heap = heaps_[0];
+    std::greater<std::pair<double, int> > later;
+    cell_search_++;
+    cell_stamps_[from] = cell_search_;
+    cell_costs_[from] = 0;
+    heap.assign(1, std::make_pair(Estimate(from, target), from));
+    for (int settled = 0; !heap.empty() && settled < kMaxDirectCells; settled++) {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      int cell = heap.back().second;
+      double cost = heap.back().first - Estimate(cell, target);
+      heap.pop_back();
+      if (cost > cell_costs_[cell] + 1e-9) {
+        continue;
+      }
+      if (cell == target) {
+        return cell_costs_[cell];
+      }
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + ring_[direction];
+        double next = cell_costs_[cell] + costs_[direction];
+        if ((free_[neighbor] || neighbor == target) && (cell_stamps_[neighbor] != cell_search_ || next < cell_costs_[neighbor])) {
+          cell_stamps_[neighbor] = cell_search_;
+          cell_costs_[neighbor] = next;
+          heap.push_back(std::make_pair(next + Estimate(neighbor, target), neighbor));
+          std::push_heap(heap.begin(), heap.end(), later);
+        }
+      }
+    }
+    return kInfinity;
+  }
+
+  /* Octile distance, the cost between two cells when nothing is in the way */
+  double Roadmap::Estimate(int cell, int target) {
+    int dx = std::abs(cell % stride_ - target % stride_);
+    int dy = std::abs(cell / stride_ - target / stride_);
+    return std::max(dx, dy) + (std::sqrt(2.0) - 1) * std::min(dx, dy);
+  }
+
+  /* Nodes attached to the cell's foot, with the cost of reaching each */
+  void Roadmap::GetSeeds(int cell, std::vector<Seed> *seeds) {
+    seeds->clear();
+    int foot = feet_[cell];
+    if (foot < 0) {
+      return;
+    }
+    for (int slot = 0; slot < 2; slot++) {
+      if (attached_nodes_[2 * foot + slot] >= 0) {
+        Seed seed = {attached_nodes_[2 * foot + slot], foot_costs_[cell] + attached_costs_[2 * foot + slot]};
+        seeds->push_back(seed);
+      }
+    }
+  }
+
+  /*
+   * Cost of joining start and goal along the run of skeleton their feet
+   * share, or infinity if they are not on the same run. Along a run
+   * between two different nodes, the cost between two cells is the
+   * difference of their costs to one end. That only holds for cells on the
+   * shortest line through the run, so feet more than kMaxChainDetour off it
+   * are not joined this way.
+   */
+  double Roadmap::JoinAlongChain(int start, int goal) {
+    const double kInfinity = std::numeric_limits<double>::infinity();
+    int start_foot = feet_[start];
+    int goal_foot = feet_[goal];
+    if (start_foot < 0 || goal_foot < 0) {
+      return kInfinity;
+    }
+    int chain = chain_of_cell_[start_foot];
+    if (chain < 0 || chain != chain_of_cell_[goal_foot] || chain_lengths_[chain] == kInfinity) {
+      return kInfinity;
+    }
+    const double *start_costs = &attached_costs_[2 * start_foot];
+    const double *goal_costs = &attached_costs_[2 * goal_foot];
+    if (start_costs[0] + start_costs[1] > chain_lengths_[chain] + kMaxChainDetour
+            || goal_costs[0] + goal_costs[1] > chain_lengths_[chain] + kMaxChainDetour) {
+      return kInfinity;
+    }
+    int goal_slot = attached_nodes_[2 * start_foot] == attached_nodes_[2 * goal_foot] ? 0 : 1;
+    return foot_costs_[start] + std::abs(start_costs[0] - goal_costs[goal_slot]) + foot_costs_[goal];
+  }
+
+  /* Lowers the cost of node on one side of the upward search, queueing it if it improved */
+  bool Roadmap::Relax(int side, int node, double cost) {
+    if (node_stamps_[side][node] == node_search_ && cost >= node_costs_[side][node]) {
+      return false;
+    }
+    node_stamps_[side][node] = node_search_;
+    node_costs_[side][node] = cost;
+    heaps_[side].push_back(std::make_pair(cost, node));
+    std::push_heap(heaps_[side].begin(), heaps_[side].end(), std::greater<std::pair<double, int> >());
+    return true;
+  }
+
+  /*
+   * Upward searches from both ends, always settling the side with the
+   * cheaper front. Every shortest route climbs to a highest ranked node
+   * and descends, so the best meeting cost is final once neither front is
+   * cheaper than it.
+   */
+  double Roadmap::SearchUpward(const std::vector<Seed> &forward, const std::vector<Seed> &backward, double best) {
+    std::greater<std::pair<double, int> > later;
+    node_search_++;
+    const std::vector<Seed> *seeds[2] = {&forward, &backward};
+    for (int side = 0; side < 2; side++) {
+      heaps_[side].clear();
+      for (const Seed &seed : *seeds[side]) {
+        Relax(side, seed.node, seed.cost);
+      }
+    }
+    while (!heaps_[0].empty() || !heaps_[1].empty()) {
+      int side = heaps_[1].empty() || (!heaps_[0].empty() && heaps_[0].front().first <= heaps_[1].front().first) ? 0 : 1;
+      std::vector<std::pair<double, int> > &heap = heaps_[side];
+      if (heap.front().first >= best) {
+        break;
+      }
+      std::pop_heap(heap.begin(), heap.end(), later);
+      double cost = heap.back().first;
+      int node = heap.back().second;
+      heap.pop_back();
+      if (cost > node_costs_[side][node]) {
+        continue;
+      }
+      if (node_stamps_[1 - side][node] == node_search_) {
+        best = std::min(best, cost + node_costs_[1 - side][node]);
+      }
+      for (int arc = up_begin_[node]; arc < up_begin_[node + 1]; arc++) {
+        Relax(side, up_arcs_[arc].to, cost + up_arcs_[arc].cost);
+      }
+    }
+    return best;
+  }
+
+  int Roadmap::Index(ModelCoordinates coordinates) {
+    return (coordinates.GetY() + 1) * stride_ + coordinates.GetX() + 1;
+  }
+} // namespace jlbot
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   roadmap.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 29, 2017, 3:05 PM
+ */
+
+#ifndef ROADMAP_H
+#define ROADMAP_H
+
+#include <utility>
+#include <vector>
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Sparse roadmap of the map's corridors for fast route cost queries.
+   *
+   * The free space is thinned to a one cell wide skeleton that runs along
+   * the middle of corridors and rooms, an approximation of its generalized
+   * Voronoi diagram. Skeleton cells where the skeleton branches or ends are
+   * the nodes, and the runs of cells between them are the edges. The graph
+   * is then preprocessed into a contraction hierarchy (Geisberger et al.,
+   * "Contraction Hierarchies: Faster and Simpler Hierarchical Routing in
+   * Road Networks"): nodes are removed least important first, and shortcuts
+   * are added wherever removing a node would lengthen a shortest path.
+   *
+   * Every cell also keeps its nearest skeleton cell, so a query joins
+   * start and goal to the graph without searching. It then meets in the
+   * middle with two searches that only follow edges toward more important
+   * nodes. Start and goal within kDirectRange are tried first with a short
+   * grid search, and those on the same run of skeleton are joined along it.
+   * Costs are in cells, with diagonal steps costing sqrt(2). They follow the
+   * skeleton, so they are the cost of a real route but may be longer than
+   * the shortest one.
+   */
+  class Roadmap {
+  public:
+    static constexpr double kNoRoute = -1;
+    Roadmap();
+    void Build(WorldModel *model);
+    bool IsCurrent(WorldModel *model);
+    double GetCost(ModelCoordinates start, ModelCoordinates goal);
+    int GetNodeCount();
+    int GetShortcutCount();
+  private:
+    static const int kWitnessSettles = 64;
+    static const int kMaxDirectCells = 1024;
+    static constexpr double kDirectRange = 32;
+    static constexpr double kMaxChainDetour = 1.5;
+
+    struct Arc {
+      int to;
+      double cost;
+    };
+
+    struct Seed {
+      int node;
+      double cost;
+    };
+    bool built_;
+    unsigned long revision_;
+    int width_;
+    int height_;
+    int stride_;
+    int ring_[8];
+    double costs_[8];
+    int shortcuts_;
+    std::vector<unsigned char> free_;
+    std::vector<unsigned char> skeleton_;
+    std::vector<int> node_of_cell_;
+    std::vector<int> chain_of_cell_;
+    std::vector<double> chain_lengths_;
+    std::vector<int> feet_;
+    std::vector<double> foot_costs_;
+    std::vector<int> nodes_;
+    std::vector<int> attached_nodes_;
+    std::vector<double> attached_costs_;
+    std::vector<std::vector<Arc> > arcs_;
+    std::vector<int> ranks_;
+    std::vector<int> up_begin_;
+    std::vector<Arc> up_arcs_;
+    std::vector<unsigned int> cell_stamps_;
+    std::vector<double> cell_costs_;
+    unsigned int cell_search_;
+    std::vector<unsigned int> node_stamps_[2];
+    std::vector<double> node_costs_[2];
+    unsigned int node_search_;
+    std::vector<std::pair<double, int> > heaps_[2];
+    std::vector<Seed> start_seeds_;
+    std::vector<Seed> goal_seeds_;
+    void Thin();
+    bool IsRemovable(int cell, int pass);
+    int CountCrossings(int cell);
+    void TraceEdges();
+    void TraceFrom(int node);
+    void Attach(int cell, int node, double cost);
+    void AddArc(int from, int to, double cost);
+    void Contract();
+    int ContractNode(int node, bool simulate, std::vector<bool> *contracted);
+    void BuildUpwardGraph();
+    void LabelChains();
+    void ComputeFeet();
+    double SearchDirect(int from, int target);
+    double Estimate(int cell, int target);
+    void GetSeeds(int cell, std::vector<Seed> *seeds);
+    double JoinAlongChain(int start, int goal);
+    bool Relax(int side, int node, double cost);
+    double SearchUpward(const std::vector<Seed> &forward, const std::vector<Seed> &backward, double best);
+    int Index(ModelCoordinates coordinates);
+  };
+} // namespace jlbot
+#endif /* ROADMAP_H */
@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   searchplanners.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 16, 2017, 11:10 AM
+ */
+
+#include "searchplanners.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include "clearanceplanner.h"
+#include "dstarliteplanner.h"
+#include "jumppointplanner.h"
+#include "thetastarplanner.h"
+
+namespace jlbot {
+
+  Planner::~Planner() {
+  }
+
+  float Planner::GetComfortClearance() {
+    return 0;
+  }
+
+  std::unique_ptr<Planner> Planner::Create(std::string name) {
+    if (name == "wavefront") {
+      return std::unique_ptr<Planner>(new WavefrontPlanner());
+    } else if (name == "astar") {
+      return std::unique_ptr<Planner>(new AStarPlanner());
+    } else if (name == "bidirectional") {
+      return std::unique_ptr<Planner>(new BidirectionalPlanner());
+    } else if (name == "dstarlite") {
+      return std::unique_ptr<Planner>(new DStarLitePlanner());
+    } else if (name == "jps") {
+      return std::unique_ptr<Planner>(new JumpPointPlanner());
+    } else if (name == "clearance") {
+      return std::unique_ptr<Planner>(new ClearancePlanner());
+    } else if (name == "thetastar") {
+      return std::unique_ptr<Planner>(new ThetaStarPlanner());
+    }
+    throw std::runtime_error("Unknown planner " + name + ".");
+  }
+
+  void SearchGrid::Reset(WorldModel *model) {
+    int width = model->GetWidth();
+    int height = model->GetHeight();
+    stride_ = width + 2;
+    /* Same order as WorldModel::GetNeighbors without the center */
+    int offsets[8] = {-stride_ - 1, -stride_, -stride_ + 1, -1, 1, stride_ - 1, stride_, stride_ + 1};
+    double diagonal = std::sqrt(2.0);
+    double costs[8] = {diagonal, 1, diagonal, 1, 1, diagonal, 1, diagonal};
+    std::copy(offsets, offsets + 8, offsets_);
+    std::copy(costs, costs + 8, costs_);
+    blocked_.assign(static_cast<std::size_t>(stride_) * (height + 2), 1);
+    const unsigned char *cells = model->GetCells();
+    for (int y = 0; y < height; y++) {
+      const unsigned char *row = cells + static_cast<std::size_t>(y) * width;
+      unsigned char *out = blocked_.data() + Index(ModelCoordinates(0, y));
+      for (int x = 0; x < width; x++) {
+        out[x] = row[x] == WorldModel::kObstacle;
+      }
+    }
+  }
+
+  int SearchGrid::GetSize() {
+    return blocked_.size();
+  }
+
+  /* Index distance between vertically adjacent cells */
+  int SearchGrid::GetStride() {
+    return stride_;
+  }
+
+  int SearchGrid::Index(ModelCoordinates coordinates) {
+    return (coordinates.GetY() + 1) * stride_ + coordinates.GetX() + 1;
+  }
+
+  ModelCoordinates SearchGrid::ToCoordinates(int index) {
+    return ModelCoordinates(index % stride_ - 1, index / stride_ - 1);
+  }
+
+  bool SearchGrid::IsBlocked(int index) {
+    return blocked_[index] != 0;
+  }
+
+  void SearchGrid::SetBlocked(int index, bool blocked) {
+    blocked_[index] = blocked;
+  }
+
+  int SearchGrid::GetOffset(int direction) {
+    return offsets_[direction];
+  }
+
+  double SearchGrid::GetCost(int direction) {
+    return costs_[direction];
+  }
+
+  /* Octile distance, the exact cost between two cells when nothing is in the way */
+  double SearchGrid::Heuristic(int a, int b) {
+    int dx = std::abs(a % stride_ - b % stride_);
+    int dy = std::abs(a / stride_ - b / stride_);
+    return std::max(dx, dy) + (std::sqrt(2.0) - 1) * std::min(dx, dy);
+  }
+
+  SearchTree::SearchTree() : search_(0) {
+  }
+
+  /* Starts a new search over cells 0 to size - 1 */
+  void SearchTree::Reset(int size) {
+    open_.Reset(size);
+    search_++;
+    if (search_ == 0 || static_cast<int>(visited_.size()) != size) {
+      search_ = 1;
+      visited_.assign(size, 0);
+      closed_.assign(size, 0);
+      costs_.resize(size);
+      parents_.resize(size);
+    }
+  }
+
+  IndexedHeap *SearchTree::GetOpen() {
+    return &open_;
+  }
+
+  bool SearchTree::IsVisited(int cell) {
+    return visited_[cell] == search_;
+  }
+
+  bool SearchTree::IsClosed(int cell) {
+    return closed_[cell] == search_;
+  }
+
+  double SearchTree::GetCost(int cell) {
+    return costs_[cell];
+  }
+
+  int SearchTree::GetParent(int cell) {
+    return parents_[cell];
+  }
+
+  void SearchTree::Visit(int cell, double cost, int parent) {
+    visited_[cell] = search_;
+    costs_[cell] = cost;
+    parents_[cell] = parent;
+  }
+
+  void SearchTree::Close(int cell) {
+    closed_[cell] = search_;
+  }
+
+  WavefrontPlanner::WavefrontPlanner() : workers_(std::max(std::thread::hardware_concurrency(), 1u)), fields_(kCachedGoals, &workers_) {
+    wave_.SetWorkerPool(&workers_);
+  }
+
+  std::string WavefrontPlanner::GetName() {
+    return "wavefront";
+  }
+
+  std::deque<ModelCoordinates> WavefrontPlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    WavefrontEngine *field = fields_.Find(model, goal);
+    if (field != NULL) {
+      std::cout << "Walking down the distance field of the goal." << std::endl;
+      return field->GetDistance(start) < 0 ? std::deque<ModelCoordinates>() : field->ExtractPath(start);
+    }
+    int count = -1;
+    for (int level = model->GetPyramidLevels() - 1; level > 0 && count == -1; level--) {
+      if (PlanCorridor(model, start, goal, level)) {
+        std::cout << "Planning inside a level " << level << " corridor." << std::endl;
+        count = PropagateWave(model, start, goal, level);
+      }
+    }
+    std::vector<unsigned char>().swap(corridor_);
+    if (count == -1) {
+      count = PropagateWave(model, start, goal, 0);
+    }
+    std::cout << "Wave reached " << wave_.GetVisitedCount() << " cells." << std::endl;
+    return count == -1 ? std::deque<ModelCoordinates>() : wave_.ExtractPath(start);
+  }
+
+  /* Runs the wave from goal to start, inside the corridor unless level is 0; returns the distance of start or -1 */
+  int WavefrontPlanner::PropagateWave(WorldModel *model, ModelCoordinates start, ModelCoordinates goal, int level) {
+    std::cout << "Propagating wave...." << std::endl;
+    wave_.Reset(model);
+    if (level != 0) {
+      wave_.Restrict(corridor_, level, corridor_width_);
+    }
+    return wave_.Propagate(start, goal);
+  }
+
+  /*
+   * Searches the given pyramid level from goal to start and keeps the coarse
+   * path, widened by one coarse cell, as the corridor the full resolution
+   * wave may enter. The coarse cells holding start and goal are always
+   * passable since they may also hold an obstacle.
+   */
+  bool WavefrontPlanner::PlanCorridor(WorldModel *model, ModelCoordinates start, ModelCoordinates goal, int level) {
+    int width = model->GetLevelWidth(level);
+    int height = model->GetLevelHeight(level);
+    int source = (goal.GetY() >> level) * width + (goal.GetX() >> level);
+    int target = (start.GetY() >> level) * width + (start.GetX() >> level);
+    std::vector<int> parents(static_cast<std::size_t>(width) * height, -1);
+    std::vector<int> fringe;
+    fringe.push_back(source);
+    parents[source] = source;
+    for (std::size_t next = 0; next < fringe.size() && parents[target] == -1; next++) {
+      int x = fringe[next] % width;
+      int y = fringe[next] / width;
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+          int nx = x + dx;
+          int ny = y + dy;
+          if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+            continue;
+          }
+          int neighbor = ny * width + nx;
+          if (parents[neighbor] == -1 && (neighbor == target || !model->IsBlocked(level, nx, ny))) {
+            parents[neighbor] = fringe[next];
+            fringe.push_back(neighbor);
+          }
+        }
+      }
+    }
+    if (parents[target] == -1) {
+      return false;
+    }
+    corridor_.assign(parents.size(), 0);
+    for (int cell = target;; cell = parents[cell]) {
+      int x = cell % width;
+      int y = cell / width;
+      for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ny++) {
+        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); nx++) {
+          corridor_[ny * width + nx] = 1;
+        }
+      }
+      if (cell == source) {
+        break;
+      }
+    }
+    corridor_width_ = width;
+    return true;
+  }
+
+  std::string AStarPlanner::GetName() {
+    return "A*";
+  }
+
+  std::deque<ModelCoordinates> AStarPlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    grid_.Reset(model);
+    int source = grid_.Index(start);
+    int target = grid_.Index(goal);
+    std::deque<ModelCoordinates> path;
+    if (grid_.IsBlocked(source)) {
+      return path;
+    }
+    /* Like the wavefront, the goal cell may be entered even if it holds an obstacle */
+    grid_.SetBlocked(target, false);
+    tree_.Reset(grid_.GetSize());
+    IndexedHeap *open = tree_.GetOpen();
+    tree_.Visit(source, 0, source);
+    open->Push(source, grid_.Heuristic(source, target));
+    int expanded = 0;
+    while (!open->IsEmpty() && open->GetTop() != target) {
+      int cell = open->Pop();
+      tree_.Close(cell);
+      expanded++;
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + grid_.GetOffset(direction);
+        if (grid_.IsBlocked(neighbor) || tree_.IsClosed(neighbor)) {
+          continue;
+        }
+        double cost = tree_.GetCost(cell) + grid_.GetCost(direction);
+        if (!tree_.IsVisited(neighbor) || cost < tree_.GetCost(neighbor)) {
+          tree_.Visit(neighbor, cost, cell);
+          open->Push(neighbor, cost + grid_.Heuristic(neighbor, target));
+        }
+      }
+    }
+    std::cout << "A* expanded " << expanded << " cells." << std::endl;
+    if (!tree_.IsVisited(target)) {
+      return path;
+    }
+    for (int cell = target; cell != source; cell = tree_.GetParent(cell)) {
+      path.push_front(grid_.ToCoordinates(cell));
+    }
+    path.push_front(start);
+    return path;
+  }
+
+  std::string BidirectionalPlanner::GetName() {
+    return "bidirectional A*";
+  }
+
+  std::deque<ModelCoordinates> BidirectionalPlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    grid_.Reset(model);
+    int source = grid_.Index(start);
+    int target = grid_.Index(goal);
+    std::deque<ModelCoordinates> path;
+    if (grid_.IsBlocked(source)) {
+      return path;
+    }
+    grid_.SetBlocked(target, false);
+    SearchTree *trees[2] = {&forward_, &backward_};
+    int ends[2] = {source, target};
+    for (int side = 0; side < 2; side++) {
+      trees[side]->Reset(grid_.GetSize());
+      trees[side]->Visit(ends[side], 0, ends[side]);
+      trees[side]->GetOpen()->Push(ends[side], grid_.Heuristic(ends[0], ends[1]));
+    }
+    double best = source == target ? 0 : std::numeric_limits<double>::infinity();
+    int meeting = source;
+    int expanded = 0;
+    while (!forward_.GetOpen()->IsEmpty() && !backward_.GetOpen()->IsEmpty()) {
+      double forward_key = forward_.GetOpen()->GetTopKey();
+      double backward_key = backward_.GetOpen()->GetTopKey();
+      if (std::max(forward_key, backward_key) >= best) {
+        break;
+      }
+      int side = forward_key <= backward_key ? 0 : 1;
+      SearchTree *tree = trees[side];
+      SearchTree *other = trees[1 - side];
+      int toward = ends[1 - side];
+      int cell = tree->GetOpen()->Pop();
+      tree->Close(cell);
+      expanded++;
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + grid_.GetOffset(direction);
+        if (grid_.IsBlocked(neighbor) || tree->IsClosed(neighbor)) {
+          continue;
+        }
+        double cost = tree->GetCost(cell) + grid_.GetCost(direction);
+        if (tree->IsVisited(neighbor) && cost >= tree->GetCost(neighbor)) {
+          continue;
+        }
+        tree->Visit(neighbor, cost, cell);
+        tree->GetOpen()->Push(neighbor, cost + grid_.Heuristic(neighbor, toward));
+        if (other->IsVisited(neighbor) && cost + other->GetCost(neighbor) < best) {
+          best = cost + other->GetCost(neighbor);
+          meeting = neighbor;
+        }
+      }
+    }
+    std::cout << "Bidirectional A* expanded " << expanded << " cells." << std::endl;
+    if (best == std::numeric_limits<double>::infinity()) {
+      return path;
+    }
+    for (int cell = meeting; cell != source; cell = forward_.GetParent(cell)) {
+      path.push_front(grid_.ToCoordinates(cell));
+    }
+    path.push_front(start);
+    for (int cell = meeting; cell != target; cell = backward_.GetParent(cell)) {
+      path.push_back(grid_.ToCoordinates(backward_.GetParent(cell)));
+    }
+    return path;
+  }
+} // namespace jlbot
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   searchplanners.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 16, 2017, 11:10 AM
+ */
+
+#ifndef SEARCHPLANNERS_H
+#define SEARCHPLANNERS_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "distancefieldcache.h"
+#include "indexedheap.h"
+#include "wavefrontengine.h"
+#include "workerpool.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /* Finds an 8-connected path of model cells for the Navigator */
+  class Planner {
+  public:
+    virtual ~Planner();
+    virtual std::string GetName() = 0;
+
+    /*
+     * Returns the cells from start to goal, or an empty path if goal cannot
+     * be reached. Any-angle planners return only the turning points, joined
+     * by clear straight lines.
+     */
+    virtual std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) = 0;
+
+    /*
+     * Shortcuts taken while relaxing a path may not pass closer to an
+     * obstacle than this, or than the path they replace where that is closer
+     */
+    virtual float GetComfortClearance();
+
+    /*
+     * Names are "wavefront", "astar", "bidirectional", "dstarlite", "jps",
+     * "thetastar" and "clearance"
+     */
+    static std::unique_ptr<Planner> Create(std::string name);
+  };
+
+  /*
+   * Model cells on a grid padded with a ring of blocked cells, addressed by
+   * linear index, with the eight neighbor offsets and their step costs.
+   */
+  class SearchGrid {
+  public:
+    void Reset(WorldModel *model);
+    int GetSize();
+    int GetStride();
+    int Index(ModelCoordinates coordinates);
+    ModelCoordinates ToCoordinates(int index);
+    bool IsBlocked(int index);
+    void SetBlocked(int index, bool blocked);
+    int GetOffset(int direction);
+    double GetCost(int direction);
+    double Heuristic(int a, int b);
+  private:
+    int stride_;
+    int offsets_[8];
+    double costs_[8];
+    std::vector<unsigned char> blocked_;
+  };
+
+  /*
+   * Costs and parents of one search direction. Entries are stamped with the
+   * search they belong to, so starting a new search does not clear them.
+   */
+  class SearchTree {
+  public:
+    SearchTree();
+    void Reset(int size);
+    IndexedHeap *GetOpen();
+    bool IsVisited(int cell);
+    bool IsClosed(int cell);
+    double GetCost(int cell);
+    int GetParent(int cell);
+    void Visit(int cell, double cost, int parent);
+    void Close(int cell);
+  private:
+    IndexedHeap open_;
+    unsigned int search_;
+    std::vector<unsigned int> visited_;
+    std::vector<unsigned int> closed_;
+    std::vector<double> costs_;
+    std::vector<int> parents_;
+  };
+
+  /*
+   * Breadth first wave from the goal. Goals with a cached distance field
+   * are answered by walking down the field. Otherwise the wave is first
+   * confined to a corridor found on the coarsest pyramid level that
+   * connects start and goal, falling back to finer levels and finally to
+   * the whole map.
+   */
+  class WavefrontPlanner : public Planner {
+  public:
+    WavefrontPlanner();
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+  private:
+    static const std::size_t kCachedGoals = 16;
+    WorkerPool workers_;
+    DistanceFieldCache fields_;
+    WavefrontEngine wave_;
+    std::vector<unsigned char> corridor_;
+    int corridor_width_;
+    bool PlanCorridor(WorldModel *model, ModelCoordinates start, ModelCoordinates goal, int level);
+    int PropagateWave(WorldModel *model, ModelCoordinates start, ModelCoordinates goal, int level);
+  };
+
+  /* A* with unit straight and sqrt(2) diagonal steps and the octile distance as heuristic */
+  class AStarPlanner : public Planner {
+  public:
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+  private:
+    SearchGrid grid_;
+    SearchTree tree_;
+  };
+
+  /*
+   * A* from both ends at once, always expanding the side with the lower top
+   * key. Stops once the best meeting cost is no larger than the top key of
+   * either side, which keeps the path optimal.
+   */
+  class BidirectionalPlanner : public Planner {
+  public:
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+  private:
+    SearchGrid grid_;
+    SearchTree forward_;
+    SearchTree backward_;
+  };
+} // namespace jlbot
+#endif /* SEARCHPLANNERS_H */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   sensorfeed.cc
+ * Author: Johnathan Louie
+ *
+ * Created on May 3, 2017, 9:50 AM
+ */
+
+#include "sensorfeed.h"
+
+namespace jlbot {
+
+  const int SensorFeed::kPollMilliseconds;
+  const int SensorFeed::kFresh;
+  const int SensorFeed::kIndexMask;
+
+  SensorFeed::SensorFeed(Robot *robot) : robot_(robot), running_(false), middle_(1), back_(0), front_(2), published_(0), command_sequence_(0), command_speed_(0), command_turn_(0), failed_(false) {
+    for (SensorSnapshot &buffer : buffers_) {
+      buffer.sequence = 0;
+      buffer.yaw = 0;
+    }
+  }
+
+  SensorFeed::~SensorFeed() {
+    Stop();
+  }
+
+  void SensorFeed::Start() {
+    running_ = true;
+    thread_ = std::thread(&SensorFeed::Ingest, this);
+  }
+
+  /* Stops the ingest thread and then the robot, unless Player already failed */
+  void SensorFeed::Stop() {
+    if (!thread_.joinable()) {
+      return;
+    }
+    running_ = false;
+    thread_.join();
+    if (!failed_.load()) {
+      robot_->Move(0, 0);
+    }
+  }
+
+  /* Throws what stopped the ingest thread, if anything did */
+  void SensorFeed::RethrowFailure() {
+    if (failed_.load(std::memory_order_acquire)) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  void SensorFeed::WaitForSnapshot() {
+    while (published_.load() == 0) {
+      RethrowFailure();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  /* The newest snapshot; it stays valid and unchanged until the next call */
+  const SensorSnapshot &SensorFeed::GetSnapshot() {
+    RethrowFailure();
+    if (middle_.load(std::memory_order_relaxed) & kFresh) {
+      front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    }
+    return buffers_[front_];
+  }
+
+  /* Writes the command under the seqlock; the sequence is odd while it is being written */
+  void SensorFeed::Command(double longitudinal_speed, double yaw_speed) {
+    unsigned int sequence = command_sequence_.load(std::memory_order_relaxed);
+    command_sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    command_speed_.store(longitudinal_speed, std::memory_order_relaxed);
+    command_turn_.store(yaw_speed, std::memory_order_relaxed);
+    command_sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /*
+   * Publishes every Player update and sends each new command. Waiting on
+   * Player is done in short polls so commands go out within
+   * kPollMilliseconds even between updates. An exception ends the thread
+   * and is kept for the reader.
+   */
+  void SensorFeed::Ingest() {
+    unsigned int sent = 0;
+    try {
+      while (running_.load()) {
+        if (robot_->Peek(kPollMilliseconds)) {
+          robot_->Read();
+          Publish();
+        }
+        unsigned int sequence;
+        double longitudinal_speed;
+        double yaw_speed;
+        if (ReadCommand(&sequence, &longitudinal_speed, &yaw_speed) && sequence != sent) {
+          robot_->Move(longitudinal_speed, yaw_speed);
+          sent = sequence;
+        }
+      }
+    } catch (...) {
+      error_ = std::current_exception();
+      failed_.store(true, std::memory_order_release);
+    }
+  }
+
+  /* Fills the back buffer, reusing its range storage, and swaps it into the middle */
+  void SensorFeed::Publish() {
+    SensorSnapshot &snapshot = buffers_[back_];
+    snapshot.sequence = published_.load(std::memory_order_relaxed) + 1;
+    snapshot.stamp = std::chrono::steady_clock::now();
+    robot_->GetScan(&snapshot.scan);
+    snapshot.position = snapshot.scan.origin;
+    snapshot.yaw = snapshot.scan.yaw;
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    published_.store(snapshot.sequence);
+  }
+
+  /* False if the command was being written; the caller tries again on its next poll */
+  bool SensorFeed::ReadCommand(unsigned int *sequence, double *longitudinal_speed, double *yaw_speed) {
+    unsigned int before = command_sequence_.load(std::memory_order_acquire);
+    if (before & 1) {
+      return false;
+    }
+    *longitudinal_speed = command_speed_.load(std::memory_order_relaxed);
+    *yaw_speed = command_turn_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    *sequence = before;
+    return command_sequence_.load(std::memory_order_relaxed) == before;
+  }
+} // namespace jlbot
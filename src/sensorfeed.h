@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   sensorfeed.h
+ * Author: Johnathan Louie
+ *
+ * Created on May 3, 2017, 9:50 AM
+ */
+
+#ifndef SENSORFEED_H
+#define SENSORFEED_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include "misc.h"
+
+namespace jlbot {
+
+  /* Pose and laser sweep from one Player update; sequence counts updates from 1 */
+  struct SensorSnapshot {
+    unsigned long sequence;
+    std::chrono::steady_clock::time_point stamp;
+    WorldCoordinates position;
+    double yaw;
+    LaserScan scan;
+  };
+
+  /*
+   * Owns the Player connection on an ingest thread. The thread reads each
+   * update into a snapshot and publishes it through a triple buffer: the
+   * ingest thread fills one buffer, the reader holds another, and the third
+   * is exchanged atomically between them, so neither side ever waits or
+   * sees a snapshot being written. Speed commands travel the other way
+   * through a seqlock and are sent by the ingest thread, which is the only
+   * thread that talks to Player while the feed runs. There may be one
+   * reader and one commanding thread. If Player fails, the ingest thread
+   * stops and the reader gets its exception from the next call.
+   */
+  class SensorFeed {
+  public:
+    SensorFeed(Robot *robot);
+    SensorFeed(const SensorFeed &) = delete;
+    SensorFeed &operator=(const SensorFeed &) = delete;
+    ~SensorFeed();
+    void Start();
+    void Stop();
+    void WaitForSnapshot();
+    const SensorSnapshot &GetSnapshot();
+    void Command(double longitudinal_speed, double yaw_speed);
+  private:
+    static const int kPollMilliseconds = 2;
+    static const int kFresh = 4;
+    static const int kIndexMask = 3;
+    Robot *robot_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    SensorSnapshot buffers_[3];
+    std::atomic<int> middle_;
+    int back_;
+    int front_;
+    std::atomic<unsigned long> published_;
+    std::atomic<unsigned int> command_sequence_;
+    std::atomic<double> command_speed_;
+    std::atomic<double> command_turn_;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_;
+    void Ingest();
+    void RethrowFailure();
+    void Publish();
+    bool ReadCommand(unsigned int *sequence, double *longitudinal_speed, double *yaw_speed);
+  };
+} // namespace jlbot
+#endif /* SENSORFEED_H */
@@ -24,18 +24,224 @@
  */
 
 #include "sensors.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace jlbot {
 
-  Sense::Sense(Robot *robot) {
-    robot_ = robot;
+  const int Sense::kLanes;
+
+  Sense::Sense(SensorFeed *feed) {
+    feed_ = feed;
+    snapshot_ = NULL;
+    copied_sequence_ = 0;
+    ranges_ = NULL;
+    beam_count_ = 0;
+  }
+
+  /* Takes the newest snapshot from the feed; call once per control cycle */
+  void Sense::Refresh() {
+    snapshot_ = &feed_->GetSnapshot();
+    if (snapshot_->sequence != copied_sequence_) {
+      CopyRanges();
+      copied_sequence_ = snapshot_->sequence;
+    }
+  }
+
+  /* Narrows the ranges to floats; the last block is padded with max range so it never wins a minimum */
+  void Sense::CopyRanges() {
+    const LaserScan &scan = snapshot_->scan;
+    beam_count_ = scan.ranges.size();
+    blocks_.resize((beam_count_ + kLanes - 1) / kLanes);
+    ranges_ = blocks_.empty() ? NULL : blocks_[0].values;
+    for (int i = 0; i < beam_count_; i++) {
+      ranges_[i] = scan.ranges[i];
+    }
+    for (int i = beam_count_; i < static_cast<int>(blocks_.size()) * kLanes; i++) {
+      ranges_[i] = scan.max_range;
+    }
+  }
+
+  /* Changes only when a new scan has arrived */
+  unsigned long Sense::GetSequence() {
+    return snapshot_->sequence;
   }
 
   WorldCoordinates Sense::GetCurrentPosition() {
-    return robot_->GetGps();
+    return snapshot_->position;
+  }
+
+  Angle Sense::GetFacing() {
+    return Angle::FromRadians(snapshot_->yaw);
+  }
+
+  const LaserScan &Sense::GetScan() {
+    return snapshot_->scan;
+  }
+
+  /* Ranges as floats, padded with max range to whole blocks; NULL before the first scan */
+  const float *Sense::GetRanges() {
+    return ranges_;
+  }
+
+  int Sense::GetBeamCount() {
+    return beam_count_;
+  }
+
+  /* Direction of beam from the robot's heading */
+  Angle Sense::GetBeamDirection(int beam) {
+    return Angle::FromRadians(snapshot_->scan.min_angle + beam * snapshot_->scan.resolution);
+  }
+
+  /* Beams first up to end whose directions lie from low to high radians; false if there are none */
+  bool Sense::GetSector(double low, double high, int *first, int *end) {
+    const LaserScan &scan = snapshot_->scan;
+    if (beam_count_ == 0 || scan.resolution <= 0) {
+      return false;
+    }
+    double lowest = std::ceil((low - scan.min_angle) / scan.resolution);
+    double highest = std::floor((high - scan.min_angle) / scan.resolution);
+    *first = static_cast<int>(std::max(lowest, 0.0));
+    *end = static_cast<int>(std::min(highest + 1, static_cast<double>(beam_count_)));
+    return *first < *end;
+  }
+
+  /* Scalar up to a block boundary, whole aligned blocks, then the scalar remainder */
+  float Sense::ReduceMin(int first, int end) {
+    float minimum = std::numeric_limits<float>::infinity();
+    int i = first;
+    for (; i < end && i % kLanes != 0; i++) {
+      minimum = std::min(minimum, ranges_[i]);
+    }
+#ifdef __SSE2__
+    __m128 lanes = _mm_set1_ps(minimum);
+    for (; i + kLanes <= end; i += kLanes) {
+      lanes = _mm_min_ps(lanes, _mm_load_ps(ranges_ + i));
+    }
+    lanes = _mm_min_ps(lanes, _mm_shuffle_ps(lanes, lanes, _MM_SHUFFLE(1, 0, 3, 2)));
+    lanes = _mm_min_ps(lanes, _mm_shuffle_ps(lanes, lanes, _MM_SHUFFLE(2, 3, 0, 1)));
+    minimum = _mm_cvtss_f32(lanes);
+#endif
+    for (; i < end; i++) {
+      minimum = std::min(minimum, ranges_[i]);
+    }
+    return minimum;
+  }
+
+  /* Splits a sector into the runs of beams it covers, two when it wraps through pi; returns how many hold beams */
+  int Sense::GetSectorPieces(Angle from, Angle to, int *firsts, int *ends) {
+    int pieces = 0;
+    if (from.ToRadians() <= to.ToRadians()) {
+      pieces += GetSector(from.ToRadians(), to.ToRadians(), &firsts[pieces], &ends[pieces]);
+    } else {
+      pieces += GetSector(from.ToRadians(), kPi, &firsts[pieces], &ends[pieces]);
+      pieces += GetSector(-kPi, to.ToRadians(), &firsts[pieces], &ends[pieces]);
+    }
+    return pieces;
+  }
+
+  /* Shortest range in the sector; max range if it holds no beam */
+  double Sense::GetMinRange(Angle from, Angle to) {
+    int firsts[2];
+    int ends[2];
+    int pieces = GetSectorPieces(from, to, firsts, ends);
+    double minimum = snapshot_->scan.max_range;
+    for (int piece = 0; piece < pieces; piece++) {
+      minimum = std::min(minimum, static_cast<double>(ReduceMin(firsts[piece], ends[piece])));
+    }
+    return minimum;
+  }
+
+  /* Beam with the shortest range in the sector, the first counterclockwise from from if several tie, or -1 if it holds none */
+  int Sense::GetClosestBeam(Angle from, Angle to) {
+    int firsts[2];
+    int ends[2];
+    int pieces = GetSectorPieces(from, to, firsts, ends);
+    int closest = -1;
+    float closest_range = 0;
+    for (int piece = 0; piece < pieces; piece++) {
+      float minimum = ReduceMin(firsts[piece], ends[piece]);
+      if (closest < 0 || minimum < closest_range) {
+        closest = FindBeam(firsts[piece], ends[piece], minimum);
+        closest_range = minimum;
+      }
+    }
+    return closest;
+  }
+
+  /*
+   * Angle spanned by the longest run of adjacent beams in the sector that
+   * all see farther than clearance. A run is not joined across pi where a
+   * wrapping sector is split.
+   */
+  double Sense::GetWidestGap(Angle from, Angle to, double clearance) {
+    int firsts[2];
+    int ends[2];
+    int pieces = GetSectorPieces(from, to, firsts, ends);
+    int widest = 0;
+    for (int piece = 0; piece < pieces; piece++) {
+      widest = std::max(widest, CountWidestRun(firsts[piece], ends[piece], clearance));
+    }
+    return widest * snapshot_->scan.resolution;
+  }
+
+  /* First beam from first up to end whose range is value; scalar up to a block boundary, then whole blocks until one holds it */
+  int Sense::FindBeam(int first, int end, float value) {
+    int i = first;
+    for (; i < end && i % kLanes != 0; i++) {
+      if (ranges_[i] == value) {
+        return i;
+      }
+    }
+#ifdef __SSE2__
+    __m128 target = _mm_set1_ps(value);
+    for (; i + kLanes <= end; i += kLanes) {
+      if (_mm_movemask_ps(_mm_cmpeq_ps(_mm_load_ps(ranges_ + i), target)) != 0) {
+        break;
+      }
+    }
+#endif
+    for (; i < end; i++) {
+      if (ranges_[i] == value) {
+        return i;
+      }
+    }
+    return -1;
   }
 
-  double Sense::GetRange(Radians direction) {
-    robot_->GetLaser(direction);
+  /* Longest run of beams from first up to end that see farther than clearance; whole blocks that are all open extend the run at once */
+  int Sense::CountWidestRun(int first, int end, double clearance) {
+    float threshold = clearance;
+    int run = 0;
+    int widest = 0;
+    int i = first;
+    for (; i < end && i % kLanes != 0; i++) {
+      run = ranges_[i] > threshold ? run + 1 : 0;
+      widest = std::max(widest, run);
+    }
+#ifdef __SSE2__
+    __m128 limit = _mm_set1_ps(threshold);
+    for (; i + kLanes <= end; i += kLanes) {
+      int open = _mm_movemask_ps(_mm_cmpgt_ps(_mm_load_ps(ranges_ + i), limit));
+      if (open == 0xF) {
+        run += kLanes;
+        widest = std::max(widest, run);
+        continue;
+      }
+      for (int lane = 0; lane < kLanes; lane++) {
+        run = (open >> lane) & 1 ? run + 1 : 0;
+        widest = std::max(widest, run);
+      }
+    }
+#endif
+    for (; i < end; i++) {
+      run = ranges_[i] > threshold ? run + 1 : 0;
+      widest = std::max(widest, run);
+    }
+    return widest;
   }
-} // namespace jlbot
\ No newline at end of file
+} // namespace jlbot
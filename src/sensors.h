@@ -26,17 +26,49 @@
 #ifndef SENSORS_H
 #define SENSORS_H
 
+#include <vector>
 #include "misc.h"
+#include "sensorfeed.h"
 
 namespace jlbot {
 
+  /*
+   * Answers every query from the snapshot taken by the last Refresh, so
+   * the readings within one control cycle agree with each other. Refresh
+   * also copies a new scan's ranges into an aligned float array, once per
+   * scan, that the sector queries reduce with SIMD. A sector runs
+   * counterclockwise from one direction to another, both taken from the
+   * robot's heading in -pi to pi, and covers every beam between them,
+   * wrapping through pi when it starts at the larger angle.
+   */
   class Sense {
   public:
-    Sense(Robot *robot);
+    Sense(SensorFeed *feed);
+    void Refresh();
+    unsigned long GetSequence();
     WorldCoordinates GetCurrentPosition();
-    double GetRange(Radians direction);
+    Angle GetFacing();
+    const LaserScan &GetScan();
+    double GetMinRange(Angle from, Angle to);
+    int GetClosestBeam(Angle from, Angle to);
+    double GetWidestGap(Angle from, Angle to, double clearance);
+    Angle GetBeamDirection(int beam);
+    const float *GetRanges();
+    int GetBeamCount();
   private:
-    Robot *robot_;
+    static const int kLanes = FloatBlock::kLanes;
+    SensorFeed *feed_;
+    const SensorSnapshot *snapshot_;
+    unsigned long copied_sequence_;
+    std::vector<FloatBlock> blocks_;
+    float *ranges_;
+    int beam_count_;
+    void CopyRanges();
+    bool GetSector(double low, double high, int *first, int *end);
+    int GetSectorPieces(Angle from, Angle to, int *firsts, int *ends);
+    float ReduceMin(int first, int end);
+    int FindBeam(int first, int end, float value);
+    int CountWidestRun(int first, int end, double clearance);
   };
 
 } // namespace jlbot
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   thetastarplanner.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 25, 2017, 9:30 AM
+ */
+
+#include "thetastarplanner.h"
+#include <cmath>
+#include <iostream>
+
+namespace jlbot {
+
+  std::string ThetaStarPlanner::GetName() {
+    return "Theta*";
+  }
+
+  std::deque<ModelCoordinates> ThetaStarPlanner::Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal) {
+    grid_.Reset(model);
+    int source = grid_.Index(start);
+    int target = grid_.Index(goal);
+    std::deque<ModelCoordinates> path;
+    if (grid_.IsBlocked(source)) {
+      return path;
+    }
+    /* Like the wavefront, the goal cell may be entered even if it holds an obstacle */
+    grid_.SetBlocked(target, false);
+    tree_.Reset(grid_.GetSize());
+    IndexedHeap *open = tree_.GetOpen();
+    tree_.Visit(source, 0, source);
+    open->Push(source, Distance(source, target));
+    int expanded = 0;
+    while (!open->IsEmpty()) {
+      int cell = open->Pop();
+      tree_.Close(cell);
+      expanded++;
+      CheckParent(model, cell);
+      if (cell == target) {
+        break;
+      }
+      int parent = tree_.GetParent(cell);
+      for (int direction = 0; direction < 8; direction++) {
+        int neighbor = cell + grid_.GetOffset(direction);
+        if (grid_.IsBlocked(neighbor) || tree_.IsClosed(neighbor)) {
+          continue;
+        }
+        double cost = tree_.GetCost(parent) + Distance(parent, neighbor);
+        if (!tree_.IsVisited(neighbor) || cost < tree_.GetCost(neighbor)) {
+          tree_.Visit(neighbor, cost, parent);
+          open->Push(neighbor, cost + Distance(neighbor, target));
+        }
+      }
+    }
+    std::cout << "Theta* expanded " << expanded << " cells." << std::endl;
+    if (!tree_.IsVisited(target)) {
+      return path;
+    }
+    for (int cell = target; cell != source; cell = tree_.GetParent(cell)) {
+      path.push_front(grid_.ToCoordinates(cell));
+    }
+    path.push_front(start);
+    return path;
+  }
+
+  /*
+   * Neighbors were given the parent of the cell that reached them without
+   * testing the line between them. If that line is blocked, the cell's
+   * parent becomes whichever closed neighbor reaches it most cheaply.
+   */
+  void ThetaStarPlanner::CheckParent(WorldModel *model, int cell) {
+    int parent = tree_.GetParent(cell);
+    if (model->IsLineClear(grid_.ToCoordinates(parent), grid_.ToCoordinates(cell))) {
+      return;
+    }
+    int best = cell;
+    double best_cost = 0;
+    for (int direction = 0; direction < 8; direction++) {
+      int neighbor = cell + grid_.GetOffset(direction);
+      if (!tree_.IsClosed(neighbor)) {
+        continue;
+      }
+      double cost = tree_.GetCost(neighbor) + grid_.GetCost(direction);
+      if (best == cell || cost < best_cost) {
+        best = neighbor;
+        best_cost = cost;
+      }
+    }
+    tree_.Visit(cell, best_cost, best);
+  }
+
+  double ThetaStarPlanner::Distance(int a, int b) {
+    int stride = grid_.GetStride();
+    int dx = a % stride - b % stride;
+    int dy = a / stride - b / stride;
+    return std::sqrt(static_cast<double>(dx * dx + dy * dy));
+  }
+} // namespace jlbot
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   thetastarplanner.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 25, 2017, 9:30 AM
+ */
+
+#ifndef THETASTARPLANNER_H
+#define THETASTARPLANNER_H
+
+#include <deque>
+#include <string>
+#include "searchplanners.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Theta* (Nash, Daniel, Koenig and Felner, "Theta*: Any-Angle Path
+   * Planning on Grids"). A* in which a cell may take its parent's parent as
+   * its own parent when the straight line between them is clear. The line
+   * is tested lazily, as in Lazy Theta* (Nash, Koenig and Tovey), once when
+   * a cell is expanded rather than once per neighbor it reaches. Costs and
+   * the heuristic are Euclidean.
+   */
+  class ThetaStarPlanner : public Planner {
+  public:
+    std::string GetName();
+    std::deque<ModelCoordinates> Plan(WorldModel *model, ModelCoordinates start, ModelCoordinates goal);
+  private:
+    SearchGrid grid_;
+    SearchTree tree_;
+    void CheckParent(WorldModel *model, int cell);
+    double Distance(int a, int b);
+  };
+} // namespace jlbot
+#endif /* THETASTARPLANNER_H */
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   trajectory.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 27, 2017, 10:40 AM
+ */
+
+#include "trajectory.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace jlbot {
+
+  constexpr double Trajectory::kMaxSpeed;
+  constexpr double Trajectory::kMaxAcceleration;
+  constexpr double Trajectory::kMaxLateralAcceleration;
+  constexpr double Trajectory::kMaxYawRate;
+  constexpr double Trajectory::kSampleSpacing;
+  constexpr double Trajectory::kMinWaypointSpacing;
+
+  Trajectory::Trajectory() {
+  }
+
+  Trajectory::Trajectory(std::deque<WorldCoordinates> waypoints, double initial_speed) {
+    for (WorldCoordinates waypoint : waypoints) {
+      if (waypoints_.empty() || waypoint.Distance(waypoints_.back()) >= kMinWaypointSpacing) {
+        waypoints_.push_back(waypoint);
+      } else if (waypoints_.size() > 1) {
+        /* The last waypoint is the goal, so it replaces a close previous waypoint rather than being dropped */
+        waypoints_.back() = waypoint;
+      }
+    }
+    if (waypoints_.empty()) {
+      return;
+    }
+    Sample();
+    ProfileSpeed(initial_speed);
+  }
+
+  bool Trajectory::IsEmpty() {
+    return samples_.empty();
+  }
+
+  double Trajectory::GetDuration() {
+    return samples_.empty() ? 0 : samples_.back().time;
+  }
+
+  /* Interpolates between the samples around time; times outside the trajectory give its ends */
+  Setpoint Trajectory::GetSetpoint(double time) {
+    if (time <= 0) {
+      return samples_.front();
+    }
+    if (time >= GetDuration()) {
+      return samples_.back();
+    }
+    std::vector<Setpoint>::iterator after = std::upper_bound(samples_.begin(), samples_.end(), time,
+            [](double t, const Setpoint & sample) {
+              return t < sample.time;
+            });
+    Setpoint before = *(after - 1);
+    Setpoint next = *after;
+    double fraction = (time - before.time) / (next.time - before.time);
+    Setpoint setpoint = before;
+    setpoint.time = time;
+    setpoint.position = WorldCoordinates(
+            before.position.GetX() + fraction * (next.position.GetX() - before.position.GetX()),
+            before.position.GetY() + fraction * (next.position.GetY() - before.position.GetY()));
+    setpoint.speed = before.speed + fraction * (next.speed - before.speed);
+    setpoint.yaw_rate = before.yaw_rate + fraction * (next.yaw_rate - before.yaw_rate);
+    return setpoint;
+  }
+
+  /* Time of the sample closest to position, used to pick up a trajectory part way along */
+  double Trajectory::GetNearestTime(WorldCoordinates position) {
+    double nearest = std::numeric_limits<double>::infinity();
+    double time = 0;
+    for (Setpoint &sample : samples_) {
+      double distance = sample.position.Distance(position);
+      if (distance < nearest) {
+        nearest = distance;
+        time = sample.time;
+      }
+    }
+    return time;
+  }
+
+  const std::deque<WorldCoordinates> &Trajectory::GetWaypoints() {
+    return waypoints_;
+  }
+
+  const std::vector<Setpoint> &Trajectory::GetSamples() {
+    return samples_;
+  }
+
+  /* Fits x and y against chord length and samples positions, headings and curvatures along each segment */
+  void Trajectory::Sample() {
+    std::size_t count = waypoints_.size();
+    std::vector<double> knots(count, 0);
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    for (std::size_t i = 0; i < count; i++) {
+      xs[i] = waypoints_[i].GetX();
+      ys[i] = waypoints_[i].GetY();
+      if (i > 0) {
+        knots[i] = knots[i - 1] + waypoints_[i].Distance(waypoints_[i - 1]);
+      }
+    }
+    std::vector<double> x_moments;
+    std::vector<double> y_moments;
+    SolveSpline(knots, xs, &x_moments);
+    SolveSpline(knots, ys, &y_moments);
+    Setpoint sample = Setpoint();
+    for (std::size_t i = 0; i + 1 < count; i++) {
+      double h = knots[i + 1] - knots[i];
+      int steps = std::max(1, static_cast<int>(std::ceil(h / kSampleSpacing)));
+      for (int step = i == 0 ? 0 : 1; step <= steps; step++) {
+        /* Cubic on [0, h] with end values v0, v1 and second derivatives m0, m1 */
+        double a = static_cast<double>(step) / steps * h;
+        double b = h - a;
+        double x = (x_moments[i] * b * b * b + x_moments[i + 1] * a * a * a) / (6 * h)
+                + (xs[i] / h - x_moments[i] * h / 6) * b + (xs[i + 1] / h - x_moments[i + 1] * h / 6) * a;
+        double y = (y_moments[i] * b * b * b + y_moments[i + 1] * a * a * a) / (6 * h)
+                + (ys[i] / h - y_moments[i] * h / 6) * b + (ys[i + 1] / h - y_moments[i + 1] * h / 6) * a;
+        double dx = (x_moments[i + 1] * a * a - x_moments[i] * b * b) / (2 * h) + (xs[i + 1] - xs[i]) / h
+                - (x_moments[i + 1] - x_moments[i]) * h / 6;
+        double dy = (y_moments[i + 1] * a * a - y_moments[i] * b * b) / (2 * h) + (ys[i + 1] - ys[i]) / h
+                - (y_moments[i + 1] - y_moments[i]) * h / 6;
+        double ddx = (x_moments[i] * b + x_moments[i + 1] * a) / h;
+        double ddy = (y_moments[i] * b + y_moments[i + 1] * a) / h;
+        double speed_squared = dx * dx + dy * dy;
+        sample.position = WorldCoordinates(x, y);
+        sample.heading = std::atan2(dy, dx);
+        sample.segment = i;
+        samples_.push_back(sample);
+        curvatures_.push_back(speed_squared > 0 ? (dx * ddy - dy * ddx) / std::pow(speed_squared, 1.5) : 0);
+      }
+    }
+    if (samples_.empty()) {
+      sample.position = waypoints_.front();
+      samples_.push_back(sample);
+      curvatures_.push_back(0);
+    }
+  }
+
+  /*
+   * Caps each sample's speed by the curvature there, then sweeps forward
+   * and backward so no two neighboring samples need more than
+   * kMaxAcceleration to get from one speed to the other. Time stamps follow
+   * from the mean speed across each step.
+   */
+  void Trajectory::ProfileSpeed(double initial_speed) {
+    std::size_t count = samples_.size();
+    std::vector<double> steps(count, 0);
+    for (std::size_t i = 0; i < count; i++) {
+      double curvature = std::abs(curvatures_[i]);
+      double speed = kMaxSpeed;
+      if (curvature > 0) {
+        speed = std::min(speed, std::sqrt(kMaxLateralAcceleration / curvature));
+        speed = std::min(speed, kMaxYawRate / curvature);
+      }
+      samples_[i].speed = speed;
+      if (i > 0) {
+        steps[i] = samples_[i].position.Distance(samples_[i - 1].position);
+      }
+    }
+    samples_.front().speed = std::min(samples_.front().speed, std::max(initial_speed, 0.0));
+    samples_.back().speed = 0;
+    for (std::size_t i = 1; i < count; i++) {
+      double reachable = std::sqrt(samples_[i - 1].speed * samples_[i - 1].speed + 2 * kMaxAcceleration * steps[i]);
+      samples_[i].speed = std::min(samples_[i].speed, reachable);
+    }
+    for (std::size_t i = count - 1; i > 0; i--) {
+      double reachable = std::sqrt(samples_[i].speed * samples_[i].speed + 2 * kMaxAcceleration * steps[i]);
+      samples_[i - 1].speed = std::min(samples_[i - 1].speed, reachable);
+    }
+    samples_.front().time = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      samples_[i].yaw_rate = samples_[i].speed * curvatures_[i];
+      if (i > 0) {
+        double mean_speed = (samples_[i - 1].speed + samples_[i].speed) / 2;
+        samples_[i].time = samples_[i - 1].time + (mean_speed > 0 ? steps[i] / mean_speed : 0);
+      }
+    }
+  }
+
+  /*
+   * Second derivatives of the natural cubic spline through (knots[i],
+   * values[i]), from the tridiagonal continuity equations solved by the
+   * Thomas algorithm. Both end moments are zero.
+   */
+  void Trajectory::SolveSpline(const std::vector<double> &knots, const std::vector<double> &values, std::vector<double> *moments) {
+    int count = static_cast<int>(knots.size());
+    moments->assign(count, 0);
+    if (count < 3) {
+      return;
+    }
+    std::vector<double> upper(count, 0);
+    std::vector<double> rhs(count, 0);
+    for (int i = 1; i < count - 1; i++) {
+      double left = knots[i] - knots[i - 1];
+      double right = knots[i + 1] - knots[i];
+      double diagonal = 2 * (left + right) - left * upper[i - 1];
+      double value = 6 * ((values[i + 1] - values[i]) / right - (values[i] - values[i - 1]) / left);
+      upper[i] = right / diagonal;
+      rhs[i] = (value - left * rhs[i - 1]) / diagonal;
+    }
+    for (int i = count - 2; i > 0; i--) {
+      (*moments)[i] = rhs[i] - upper[i] * (*moments)[i + 1];
+    }
+  }
+} // namespace jlbot
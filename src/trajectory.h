@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   trajectory.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 27, 2017, 10:40 AM
+ */
+
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <deque>
+#include <vector>
+#include "geometry.h"
+#include "misc.h"
+
+namespace jlbot {
+
+  /* Where the robot should be at time seconds after the trajectory starts, and how it should be moving */
+  struct Setpoint {
+    double time;
+    WorldCoordinates position;
+    double heading;
+    double speed;
+    double yaw_rate;
+
+    /* Index of the waypoint the setpoint's spline segment starts at */
+    int segment;
+  };
+
+  /*
+   * Natural cubic spline through the waypoints, parameterized by chord
+   * length, so position, heading and curvature are continuous. The spline
+   * is sampled every kSampleSpacing meters and given a speed profile that
+   * keeps within the speed, acceleration, lateral acceleration and yaw rate
+   * limits and comes to rest at the last waypoint. Waypoints closer than
+   * kMinWaypointSpacing to the previous one are dropped.
+   */
+  class Trajectory {
+  public:
+    static constexpr double kMaxSpeed = 2;
+    static constexpr double kMaxAcceleration = 1;
+    static constexpr double kMaxLateralAcceleration = 1;
+    static constexpr double kMaxYawRate = kPi / 3;
+    Trajectory();
+    Trajectory(std::deque<WorldCoordinates> waypoints, double initial_speed);
+    bool IsEmpty();
+    double GetDuration();
+    Setpoint GetSetpoint(double time);
+    double GetNearestTime(WorldCoordinates position);
+    const std::deque<WorldCoordinates> &GetWaypoints();
+    const std::vector<Setpoint> &GetSamples();
+  private:
+    static constexpr double kSampleSpacing = 0.05;
+    static constexpr double kMinWaypointSpacing = 0.1;
+    std::deque<WorldCoordinates> waypoints_;
+    std::vector<Setpoint> samples_;
+    std::vector<double> curvatures_;
+    void Sample();
+    void ProfileSpeed(double initial_speed);
+    static void SolveSpline(const std::vector<double> &knots, const std::vector<double> &values, std::vector<double> *moments);
+  };
+} // namespace jlbot
+#endif /* TRAJECTORY_H */
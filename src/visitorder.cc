@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   visitorder.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 28, 2017, 1:20 PM
+ */
+
+#include "visitorder.h"
+#include <algorithm>
+
+namespace jlbot {
+
+  const int VisitOrder::kMaxMovedRun;
+  const long VisitOrder::kNoWayCost;
+
+  VisitOrder::VisitOrder(const std::vector<std::vector<long> > &costs) : costs_(costs) {
+  }
+
+  /* Stop indices in visiting order, beginning with 0 */
+  std::vector<int> VisitOrder::Solve() {
+    std::vector<int> route = InsertNearest();
+    while (TwoOpt(&route) || OrOpt(&route)) {
+    }
+    return route;
+  }
+
+  long VisitOrder::GetCost(const std::vector<int> &route) {
+    long cost = 0;
+    for (std::size_t i = 1; i < route.size(); i++) {
+      cost += Cost(route[i - 1], route[i]);
+    }
+    return cost;
+  }
+
+  /* Position -1 and the position past the end stand for the open end of the route, which costs nothing to reach */
+  long VisitOrder::Cost(int from, int to) {
+    if (from < 0 || to < 0) {
+      return 0;
+    }
+    long cost = costs_[from][to];
+    return cost < 0 ? kNoWayCost : cost;
+  }
+
+  /*
+   * Repeatedly takes the stop closest to any stop already on the route and
+   * inserts it where it adds the least cost, which may be the end.
+   */
+  std::vector<int> VisitOrder::InsertNearest() {
+    int count = costs_.size();
+    std::vector<int> route(1, 0);
+    std::vector<long> nearest(count);
+    std::vector<bool> routed(count, false);
+    routed[0] = true;
+    for (int stop = 0; stop < count; stop++) {
+      nearest[stop] = Cost(0, stop);
+    }
+    for (int added = 1; added < count; added++) {
+      int next = -1;
+      for (int stop = 0; stop < count; stop++) {
+        if (!routed[stop] && (next < 0 || nearest[stop] < nearest[next])) {
+          next = stop;
+        }
+      }
+      std::size_t best_position = route.size();
+      long best_increase = Cost(route.back(), next);
+      for (std::size_t position = 1; position < route.size(); position++) {
+        long increase = Cost(route[position - 1], next) + Cost(next, route[position]) - Cost(route[position - 1], route[position]);
+        if (increase < best_increase) {
+          best_increase = increase;
+          best_position = position;
+        }
+      }
+      route.insert(route.begin() + best_position, next);
+      routed[next] = true;
+      for (int stop = 0; stop < count; stop++) {
+        nearest[stop] = std::min(nearest[stop], Cost(next, stop));
+      }
+    }
+    return route;
+  }
+
+  /* Applies the first reversal of route[i..j] that shortens the route */
+  bool VisitOrder::TwoOpt(std::vector<int> *route) {
+    std::vector<int> &stops = *route;
+    int count = stops.size();
+    for (int i = 1; i < count - 1; i++) {
+      for (int j = i + 1; j < count; j++) {
+        int after = j + 1 < count ? stops[j + 1] : -1;
+        long removed = Cost(stops[i - 1], stops[i]) + Cost(stops[j], after);
+        long added = Cost(stops[i - 1], stops[j]) + Cost(stops[i], after);
+        if (added < removed) {
+          std::reverse(stops.begin() + i, stops.begin() + j + 1);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /* Applies the first move of a run route[i..i + length - 1] to between two other stops that shortens the route */
+  bool VisitOrder::OrOpt(std::vector<int> *route) {
+    std::vector<int> &stops = *route;
+    int count = stops.size();
+    for (int length = 1; length <= kMaxMovedRun; length++) {
+      for (int i = 1; i + length <= count; i++) {
+        int first = stops[i];
+        int last = stops[i + length - 1];
+        int after = i + length < count ? stops[i + length] : -1;
+        long removed = Cost(stops[i - 1], first) + Cost(last, after) - Cost(stops[i - 1], after);
+        /* The run goes between stops[k] and stops[k + 1], with k outside the run */
+        for (int k = 0; k < count; k++) {
+          if (k >= i - 1 && k < i + length) {
+            continue;
+          }
+          int next = k + 1 < count ? stops[k + 1] : -1;
+          long added = Cost(stops[k], first) + Cost(last, next) - Cost(stops[k], next);
+          if (added < removed) {
+            std::vector<int> run(stops.begin() + i, stops.begin() + i + length);
+            stops.erase(stops.begin() + i, stops.begin() + i + length);
+            int position = k < i ? k + 1 : k + 1 - length;
+            stops.insert(stops.begin() + position, run.begin(), run.end());
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+} // namespace jlbot
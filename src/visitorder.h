@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   visitorder.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 28, 2017, 1:20 PM
+ */
+
+#ifndef VISITORDER_H
+#define VISITORDER_H
+
+#include <vector>
+
+namespace jlbot {
+
+  /*
+   * Order in which to visit a round of stops, starting at stop 0 and ending
+   * wherever is cheapest. The route is built by nearest insertion and then
+   * improved by 2-opt (reversing a run of stops) and Or-opt (moving a run
+   * of up to kMaxMovedRun stops elsewhere) until neither shortens it.
+   * Costs are between every pair of stops and assumed symmetric; a
+   * negative cost means there is no way between two stops and counts as
+   * kNoWayCost, more than any route that exists.
+   */
+  class VisitOrder {
+  public:
+    VisitOrder(const std::vector<std::vector<long> > &costs);
+    std::vector<int> Solve();
+    long GetCost(const std::vector<int> &route);
+  private:
+    static const int kMaxMovedRun = 3;
+    static const long kNoWayCost = 1L << 40;
+    const std::vector<std::vector<long> > &costs_;
+    long Cost(int from, int to);
+    std::vector<int> InsertNearest();
+    bool TwoOpt(std::vector<int> *route);
+    bool OrOpt(std::vector<int> *route);
+  };
+} // namespace jlbot
+#endif /* VISITORDER_H */
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   wavefrontengine.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 15, 2017, 2:20 PM
+ */
+
+#include "wavefrontengine.h"
+#include <algorithm>
+
+namespace jlbot {
+
+  const int WavefrontEngine::kUnreached;
+  const int WavefrontEngine::kBlocked;
+  const std::size_t WavefrontEngine::kParallelRing;
+  const std::size_t WavefrontEngine::kBlockSize;
+
+  WavefrontEngine::WavefrontEngine() : workers_(NULL), width_(0), height_(0), stride_(0), visited_(0), next_block_(0), ring_end_(0), ring_distance_(0) {
+  }
+
+  /* Large rings are expanded on the pool's threads; NULL keeps the wave on the calling thread */
+  void WavefrontEngine::SetWorkerPool(WorkerPool *workers) {
+    workers_ = workers;
+  }
+
+  /* Marks the model's obstacles and the padding blocked and every other cell unreached */
+  void WavefrontEngine::Reset(WorldModel *model) {
+    width_ = model->GetWidth();
+    height_ = model->GetHeight();
+    stride_ = width_ + 2;
+    /* Same order as WorldModel::GetNeighbors without the center */
+    int offsets[8] = {-stride_ - 1, -stride_, -stride_ + 1, -1, 1, stride_ - 1, stride_, stride_ + 1};
+    std::copy(offsets, offsets + 8, offsets_);
+    std::size_t size = static_cast<std::size_t>(stride_) * (height_ + 2);
+    distances_.assign(size, kBlocked);
+    queue_.resize(size);
+    const unsigned char *cells = model->GetCells();
+    for (int y = 0; y < height_; y++) {
+      const unsigned char *row = cells + static_cast<std::size_t>(y) * width_;
+      int *out = distances_.data() + Index(ModelCoordinates(0, y));
+      for (int x = 0; x < width_; x++) {
+        out[x] = row[x] == WorldModel::kObstacle ? kBlocked : kUnreached;
+      }
+    }
+  }
+
+  /* Blocks every cell whose cell on the given pyramid level is not part of the corridor */
+  void WavefrontEngine::Restrict(const std::vector<unsigned char> &corridor, int level, int corridor_width) {
+    for (int y = 0; y < height_; y++) {
+      const unsigned char *coarse = corridor.data() + static_cast<std::size_t>(y >> level) * corridor_width;
+      int *out = distances_.data() + Index(ModelCoordinates(0, y));
+      for (int x = 0; x < width_; x++) {
+        if (coarse[x >> level] == 0) {
+          out[x] = kBlocked;
+        }
+      }
+    }
+  }
+
+  /* Spreads the wave from goal until it labels start and returns the distance of start, or -1 */
+  int WavefrontEngine::Propagate(ModelCoordinates start, ModelCoordinates goal) {
+    if (!IsInside(start) || !IsInside(goal)) {
+      return -1;
+    }
+    int target = Index(start);
+    Spread(Index(goal), target);
+    return distances_[target] < 0 ? -1 : distances_[target];
+  }
+
+  /* Labels every cell the wave from goal can reach, so paths can be extracted from any start */
+  void WavefrontEngine::Flood(ModelCoordinates goal) {
+    if (IsInside(goal)) {
+      Spread(Index(goal), -1);
+    }
+  }
+
+  /* Frees the queue and worker buffers; the distances stay valid for ExtractPath */
+  void WavefrontEngine::ReleaseBuffers() {
+    std::vector<int>().swap(queue_);
+    std::vector<std::vector<int> >().swap(outputs_);
+  }
+
+  /* Breadth first from source until target is labelled, or until the wave dies out if target is -1 */
+  void WavefrontEngine::Spread(int source, int target) {
+    int *distances = distances_.data();
+    int *queue = queue_.data();
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    distances[source] = 0;
+    queue[tail++] = source;
+    for (int distance = 1; head < tail && (target == -1 || distances[target] < 0); distance++) {
+      std::size_t end = tail;
+      if (workers_ != NULL && workers_->GetThreadCount() > 1 && end - head >= kParallelRing) {
+        tail = SpreadParallel(head, end, distance, tail);
+        head = end;
+        continue;
+      }
+      for (; head < end; head++) {
+        int cell = queue[head];
+        for (int offset : offsets_) {
+          int neighbor = cell + offset;
+          if (distances[neighbor] == kUnreached) {
+            distances[neighbor] = distance;
+            queue[tail++] = neighbor;
+          }
+        }
+      }
+    }
+    visited_ = tail;
+  }
+
+  /* Expands queue[begin, end) on every worker and returns the new tail of the queue */
+  std::size_t WavefrontEngine::SpreadParallel(std::size_t begin, std::size_t end, int distance, std::size_t tail) {
+    outputs_.resize(workers_->GetThreadCount());
+    next_block_ = begin;
+    ring_end_ = end;
+    ring_distance_ = distance;
+    workers_->Run([this](int worker) {
+      ExpandBlocks(worker);
+    });
+    for (std::vector<int> &output : outputs_) {
+      std::copy(output.begin(), output.end(), queue_.begin() + tail);
+      tail += output.size();
+      output.clear();
+    }
+    return tail;
+  }
+
+  void WavefrontEngine::ExpandBlocks(int worker) {
+    int *distances = distances_.data();
+    std::vector<int> &output = outputs_[worker];
+    while (true) {
+      std::size_t begin = next_block_.fetch_add(kBlockSize);
+      if (begin >= ring_end_) {
+        return;
+      }
+      std::size_t end = std::min(begin + kBlockSize, ring_end_);
+      for (std::size_t i = begin; i < end; i++) {
+        int cell = queue_[i];
+        for (int offset : offsets_) {
+          int neighbor = cell + offset;
+          int expected = kUnreached;
+          if (__atomic_load_n(distances + neighbor, __ATOMIC_RELAXED) == kUnreached &&
+              __atomic_compare_exchange_n(distances + neighbor, &expected, ring_distance_, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            output.push_back(neighbor);
+          }
+        }
+      }
+    }
+  }
+
+  /* Walks downhill from start to the goal; empty from a start off the map */
+  std::deque<ModelCoordinates> WavefrontEngine::ExtractPath(ModelCoordinates start) {
+    std::deque<ModelCoordinates> path;
+    if (!IsInside(start)) {
+      return path;
+    }
+    int cell = Index(start);
+    path.push_back(start);
+    for (int distance = distances_[cell]; distance > 0; distance--) {
+      for (int offset : offsets_) {
+        if (distances_[cell + offset] == distance - 1) {
+          cell += offset;
+          break;
+        }
+      }
+      path.push_back(ToCoordinates(cell));
+    }
+    return path;
+  }
+
+  /* Cells off the map read as blocked */
+  int WavefrontEngine::GetDistance(ModelCoordinates coordinates) {
+    if (!IsInside(coordinates)) {
+      return kBlocked;
+    }
+    return distances_[Index(coordinates)];
+  }
+
+  /* Cells labelled by the last Propagate */
+  int WavefrontEngine::GetVisitedCount() {
+    return visited_;
+  }
+
+  bool WavefrontEngine::IsInside(ModelCoordinates coordinates) {
+    return coordinates.GetX() >= 0 && coordinates.GetY() >= 0 && coordinates.GetX() < width_ && coordinates.GetY() < height_;
+  }
+
+  int WavefrontEngine::Index(ModelCoordinates coordinates) {
+    return (coordinates.GetY() + 1) * stride_ + coordinates.GetX() + 1;
+  }
+
+  ModelCoordinates WavefrontEngine::ToCoordinates(int index) {
+    return ModelCoordinates(index % stride_ - 1, index / stride_ - 1);
+  }
+} // namespace jlbot
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   wavefrontengine.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 15, 2017, 2:20 PM
+ */
+
+#ifndef WAVEFRONTENGINE_H
+#define WAVEFRONTENGINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "workerpool.h"
+#include "worldmodel.h"
+
+namespace jlbot {
+
+  /*
+   * Breadth first wavefront over linear cell indices. The grid is padded
+   * with a ring of blocked cells so neighbors are found with eight fixed
+   * offsets and no bounds checks. Distances and the queue are sized once
+   * per map and reused by every search; every cell enters the queue at most
+   * once, so the queue never wraps.
+   *
+   * The wave advances one ring at a time. With a worker pool, rings of at
+   * least kParallelRing cells are split into blocks that the workers claim
+   * in turn. Workers claim cells with a compare-and-swap on the distance,
+   * collect them in their own buffers, and the buffers are appended to the
+   * queue after the ring. Every cell still gets its breadth first distance,
+   * so the distances and paths match the serial wave exactly.
+   *
+   * The entry points check their cells against the map: a goal or start
+   * off the map reaches nothing and reads as blocked, so callers need not
+   * check bounds first.
+   */
+  class WavefrontEngine {
+  public:
+    static const int kUnreached = -1;
+    static const int kBlocked = -2;
+    WavefrontEngine();
+    WavefrontEngine(const WavefrontEngine &) = delete;
+    WavefrontEngine &operator=(const WavefrontEngine &) = delete;
+    void SetWorkerPool(WorkerPool *workers);
+    void Reset(WorldModel *model);
+    void Restrict(const std::vector<unsigned char> &corridor, int level, int corridor_width);
+    int Propagate(ModelCoordinates start, ModelCoordinates goal);
+    void Flood(ModelCoordinates goal);
+    void ReleaseBuffers();
+    std::deque<ModelCoordinates> ExtractPath(ModelCoordinates start);
+    int GetDistance(ModelCoordinates coordinates);
+    int GetVisitedCount();
+  private:
+    static const std::size_t kParallelRing = 4096;
+    static const std::size_t kBlockSize = 256;
+    WorkerPool *workers_;
+    int width_;
+    int height_;
+    int stride_;
+    int offsets_[8];
+    int visited_;
+    std::vector<int> distances_;
+    std::vector<int> queue_;
+    std::vector<std::vector<int> > outputs_;
+    std::atomic<std::size_t> next_block_;
+    std::size_t ring_end_;
+    int ring_distance_;
+    void Spread(int source, int target);
+    std::size_t SpreadParallel(std::size_t begin, std::size_t end, int distance, std::size_t tail);
+    void ExpandBlocks(int worker);
+    bool IsInside(ModelCoordinates coordinates);
+    int Index(ModelCoordinates coordinates);
+    ModelCoordinates ToCoordinates(int index);
+  };
+} // namespace jlbot
+#endif /* WAVEFRONTENGINE_H */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   workerpool.cc
+ * Author: Johnathan Louie
+ *
+ * Created on April 21, 2017, 3:05 PM
+ */
+
+#include "workerpool.h"
+
+namespace jlbot {
+
+  WorkerPool::WorkerPool(int thread_count) : round_(0), busy_(0), stopping_(false) {
+    for (int worker = 1; worker < thread_count; worker++) {
+      threads_.push_back(std::thread(&WorkerPool::Work, this, worker));
+    }
+  }
+
+  WorkerPool::~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  int WorkerPool::GetThreadCount() {
+    return threads_.size() + 1;
+  }
+
+  /* Runs task(worker) on every worker and returns when all of them have finished */
+  void WorkerPool::Run(std::function<void(int)> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = task;
+      busy_ = threads_.size();
+      round_++;
+    }
+    wake_.notify_all();
+    task(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] {
+      return busy_ == 0;
+    });
+  }
+
+  void WorkerPool::Work(int worker) {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [this, seen] {
+        return stopping_ || round_ != seen;
+      });
+      if (stopping_) {
+        return;
+      }
+      seen = round_;
+      std::function<void(int)> task = task_;
+      lock.unlock();
+      task(worker);
+      lock.lock();
+      if (--busy_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+} // namespace jlbot
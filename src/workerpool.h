@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+/*
+ * File:   workerpool.h
+ * Author: Johnathan Louie
+ *
+ * Created on April 21, 2017, 3:05 PM
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jlbot {
+
+  /*
+   * Fixed set of threads that all run the same task and then wait for the
+   * next one. The calling thread takes part as worker 0, so a pool of one
+   * thread starts no threads at all.
+   */
+  class WorkerPool {
+  public:
+    WorkerPool(int thread_count);
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+    ~WorkerPool();
+    int GetThreadCount();
+    void Run(std::function<void(int)> task);
+  private:
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::function<void(int)> task_;
+    unsigned long round_;
+    int busy_;
+    bool stopping_;
+    void Work(int worker);
+  };
+} // namespace jlbot
+#endif /* WORKERPOOL_H */
@@ -24,11 +24,30 @@
  */
 
 #include "worldmodel.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "mappedfile.h"
 
 namespace jlbot {
 
+  const unsigned char WorldModel::kEmpty;
+  const unsigned char WorldModel::kObstacle;
+  const unsigned char WorldModel::kPath;
+  const int WorldModel::kScaleMap;
+  constexpr double WorldModel::kWorldWidth;
+  constexpr double WorldModel::kWorldHeight;
+
   ModelCoordinates::ModelCoordinates() {
   }
 
@@ -49,15 +68,6 @@ namespace jlbot {
     return x_ == other.x_ && y_ == other.y_;
   }
 
-  /* Initialize map to 0's, meaning all free space */
-  void WorldModel::Empty() {
-    for (int y = 0; y < kGridRows; y++) {
-      for (int x = 0; x < kGridCols; x++) {
-        SetEmpty(ModelCoordinates(x, y));
-      }
-    }
-  }
-
   void WorldModel::SetEmpty(ModelCoordinates coordinates) {
     SetValue(coordinates, kEmpty);
   }
@@ -70,27 +80,116 @@ namespace jlbot {
     SetValue(coordinates, kPath);
   }
 
-  void WorldModel::ReadMap(std::string filename) {
-    std::cout << "Creating world model...." << std::endl;
-    std::ifstream stream(filename);
-    /* Read past first line */
-    stream.getline(pnm_first_line_, 80);
-    /* Read in width, height, maxVal */
-    stream >> pnm_width_ >> pnm_height_ >> pnm_max_val_;
-    model_height_ = pnm_height_ / kScaleMap;
-    model_width_ = pnm_width_ / kScaleMap;
-    /* Read in map; */
-    for (int i = 0; i < pnm_height_; i++) {
-      for (int j = 0; j < pnm_width_; j++) {
-        char next_char;
-        stream >> next_char;
-        if (!next_char) {
-          int y = i / kScaleMap;
-          int x = j / kScaleMap;
-          SetObstacle(ModelCoordinates(x, y));
+  /* Parses a P5 header and returns the offset of the first raster byte */
+  std::size_t WorldModel::ReadPnmHeader(const unsigned char *data, std::size_t size, int *width, int *height) {
+    if (size < 2 || data[0] != 'P' || data[1] != '5') {
+      throw std::runtime_error("Map is not a binary greyscale (P5) PNM file.");
+    }
+    std::size_t offset = 2;
+    int max_val;
+    int *fields[] = {width, height, &max_val};
+    for (int *field : fields) {
+      /* Skip whitespace and comments */
+      while (offset < size && (std::isspace(data[offset]) || data[offset] == '#')) {
+        if (data[offset] == '#') {
+          while (offset < size && data[offset] != '\n') {
+            offset++;
+          }
+        } else {
+          offset++;
         }
       }
+      if (offset == size || !std::isdigit(data[offset])) {
+        throw std::runtime_error("Map has a malformed PNM header.");
+      }
+      *field = 0;
+      while (offset < size && std::isdigit(data[offset])) {
+        *field = *field * 10 + (data[offset] - '0');
+        offset++;
+      }
+    }
+    if (max_val > 255) {
+      throw std::runtime_error("Map uses 16-bit pixels, which are not supported.");
+    }
+    /* A single whitespace byte separates the header from the raster */
+    if (offset == size || !std::isspace(data[offset])) {
+      throw std::runtime_error("Map has a malformed PNM header.");
+    }
+    return offset + 1;
+  }
+
+  /*
+   * Column-wise minimum of width pixels over kScaleMap raster rows that are
+   * stride bytes apart, so a black pixel anywhere in the column survives
+   */
+  void WorldModel::PoolRows(const unsigned char *rows, std::size_t stride, int width, unsigned char *pooled) {
+    std::memcpy(pooled, rows, width);
+    for (int r = 1; r < kScaleMap; r++) {
+      const unsigned char *row = rows + r * stride;
+      int x = 0;
+#ifdef __SSE2__
+      for (; x + 16 <= width; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pooled + x));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pooled + x), _mm_min_epu8(a, b));
+      }
+#endif
+      for (; x < width; x++) {
+        pooled[x] = std::min(pooled[x], row[x]);
+      }
+    }
+  }
+
+  /* Reduces each run of kScaleMap pooled pixels to one of count model cells */
+  void WorldModel::PoolColumns(const unsigned char *pooled, int count, unsigned char *cells) {
+    int x = 0;
+#ifdef __SSE2__
+    if (kScaleMap == 2) {
+      const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+      const __m128i black = _mm_setzero_si128();
+      const __m128i obstacle = _mm_set1_epi8(kObstacle);
+      for (; x + 16 <= count; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pooled + 2 * x));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pooled + 2 * x + 16));
+        a = _mm_and_si128(_mm_min_epu8(a, _mm_srli_epi16(a, 8)), low_bytes);
+        b = _mm_and_si128(_mm_min_epu8(b, _mm_srli_epi16(b, 8)), low_bytes);
+        __m128i block_min = _mm_packus_epi16(a, b);
+        __m128i cell = _mm_and_si128(_mm_cmpeq_epi8(block_min, black), obstacle);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(cells + x), cell);
+      }
     }
+#endif
+    for (; x < count; x++) {
+      const unsigned char *block = pooled + static_cast<std::size_t>(x) * kScaleMap;
+      unsigned char block_min = *std::min_element(block, block + kScaleMap);
+      cells[x] = block_min == 0 ? kObstacle : kEmpty;
+    }
+  }
+
+  void WorldModel::ReadMap(std::string filename) {
+    std::cout << "Creating world model...." << std::endl;
+    MappedFile file(filename);
+    const unsigned char *data = file.GetData();
+    int pnm_width;
+    int pnm_height;
+    std::size_t offset = ReadPnmHeader(data, file.GetSize(), &pnm_width, &pnm_height);
+    std::size_t row_size = pnm_width;
+    if (offset > file.GetSize() || file.GetSize() - offset < row_size * pnm_height) {
+      throw std::runtime_error("Map " + filename + " is truncated.");
+    }
+    model_height_ = pnm_height / kScaleMap;
+    model_width_ = pnm_width / kScaleMap;
+    cells_.Assign(static_cast<std::size_t>(model_width_) * model_height_, kEmpty);
+    clearance_.Release();
+    unsigned char *cells = cells_.GetMutableData();
+    /* Any black pixel in a kScaleMap x kScaleMap block makes the cell an obstacle */
+    std::vector<unsigned char> pooled(pnm_width);
+    for (int y = 0; y < model_height_; y++) {
+      const unsigned char *rows = data + offset + static_cast<std::size_t>(y) * kScaleMap * row_size;
+      PoolRows(rows, row_size, pnm_width, pooled.data());
+      PoolColumns(pooled.data(), model_width_, cells + static_cast<std::size_t>(y) * model_width_);
+    }
+    BuildOccupancy();
     std::cout << "World model complete." << std::endl;
     std::cout << "World dimensions (meters)" << std::endl;
     std::cout << " - Width: " << kWorldWidth << std::endl;
@@ -103,34 +202,42 @@ namespace jlbot {
     std::cout << " - Height: " << model_height_ / kWorldHeight << std::endl;
   }
 
+  /* Revisions are unique across all models, so a different map never matches */
+  std::atomic<unsigned long> WorldModel::last_revision_(0);
+
+  WorldModel::WorldModel() : model_height_(0), model_width_(0), revision_(0) {
+  }
+
   WorldModel::WorldModel(std::string filename) {
-    Empty();
     ReadMap(filename);
   }
 
   void WorldModel::Save(std::string filename) {
     std::cout << "Saving world model...." << std::endl;
-    std::ofstream stream(filename);
-    stream << pnm_first_line_ << std::endl;
-    stream << model_width_ << " " << model_height_ << std::endl;
-    stream << pnm_max_val_ << std::endl;
-    for (int y = 0; y < model_height_; y++) {
-      for (int x = 0; x < model_width_; x++) {
-        ModelCoordinates position(x, y);
-        unsigned char greyscale = 255;
-        if (IsObstacle(position)) {
-          greyscale = 180;
-        } else if (IsEmpty(position)) {
-          greyscale = 255;
-        } else if (IsPath(position)) {
-          greyscale = 0;
-        }
-        stream << greyscale;
-      }
-    }
+    std::string image = EncodePnm(cells_.GetData(), model_width_, model_height_);
+    std::ofstream stream(filename, std::ios::binary);
+    stream.write(image.data(), image.size());
     std::cout << "Save complete." << std::endl;
   }
 
+  /* Renders a cell layer as a greyscale P5 image: obstacles grey, free space white, paths black */
+  std::string WorldModel::EncodePnm(const unsigned char *cells, int width, int height) {
+    std::ostringstream header;
+    header << "P5" << std::endl << width << " " << height << std::endl << 255 << std::endl;
+    std::string image = header.str();
+    std::size_t offset = image.size();
+    std::size_t size = static_cast<std::size_t>(width) * height;
+    image.resize(offset + size);
+    unsigned char greyscale[256];
+    std::fill(greyscale, greyscale + 256, 255);
+    greyscale[kObstacle] = 180;
+    greyscale[kPath] = 0;
+    for (std::size_t i = 0; i < size; i++) {
+      image[offset + i] = greyscale[cells[i]];
+    }
+    return image;
+  }
+
   ModelCoordinates WorldModel::WorldToModel(WorldCoordinates world) {
     int x = (world.GetX() + kWorldWidth / 2) / kWorldWidth * model_width_;
     int y = (-world.GetY() + kWorldHeight / 2) / kWorldHeight * model_height_;
@@ -143,12 +250,299 @@ namespace jlbot {
     return WorldCoordinates(x, y);
   }
 
-  int WorldModel::GetValue(ModelCoordinates coordinates) {
-    return grid_map_[coordinates.GetY()][coordinates.GetX()];
+  std::size_t WorldModel::Index(ModelCoordinates coordinates) {
+    return static_cast<std::size_t>(coordinates.GetY()) * model_width_ + coordinates.GetX();
+  }
+
+  unsigned char WorldModel::GetValue(ModelCoordinates coordinates) {
+    return cells_.Get(Index(coordinates));
+  }
+
+  void WorldModel::SetValue(ModelCoordinates coordinates, unsigned char value) {
+    Touch();
+    cells_.Set(Index(coordinates), value);
+    occupancy_.Set(coordinates.GetX(), coordinates.GetY(), value == kObstacle);
+    /* Coarse levels stay conservative: a cleared cell leaves its ancestors blocked */
+    if (value == kObstacle) {
+      for (std::size_t level = 1; level <= pyramid_.size(); level++) {
+        pyramid_[level - 1].Set(coordinates.GetX() >> level, coordinates.GetY() >> level, true);
+      }
+    }
+  }
+
+  /* Changes whenever a cell changes; consumers compare it to tell whether derived data is stale */
+  unsigned long WorldModel::GetRevision() {
+    return revision_;
+  }
+
+  void WorldModel::Touch() {
+    revision_ = ++last_revision_;
+  }
+
+  const unsigned char *WorldModel::GetCells() {
+    return cells_.GetData();
+  }
+
+  /* Adopts a cell layer that lives in a mapped file, such as a map cache */
+  void WorldModel::BorrowCells(int width, int height, const unsigned char *cells, std::shared_ptr<MappedFile> backing) {
+    model_width_ = width;
+    model_height_ = height;
+    cells_.Borrow(cells, static_cast<std::size_t>(width) * height, backing);
+    clearance_.Release();
+    BuildOccupancy();
+  }
+
+  /* Packs the obstacle cells into the occupancy bitmap, 64 cells per word */
+  void WorldModel::BuildOccupancy() {
+    Touch();
+    pyramid_.clear();
+    occupancy_.Resize(model_width_, model_height_);
+    const unsigned char *cells = cells_.GetData();
+    for (int y = 0; y < model_height_; y++) {
+      occupancy_.PackRow(y, cells + static_cast<std::size_t>(y) * model_width_, kObstacle);
+    }
+  }
+
+  const float *WorldModel::GetClearances() {
+    return clearance_.GetData();
+  }
+
+  void WorldModel::BorrowClearances(const float *clearances, std::shared_ptr<MappedFile> backing) {
+    clearance_.Borrow(clearances, cells_.GetSize(), backing);
+  }
+
+  /*
+   * One dimensional squared distance transform of a sampled function
+   * (Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled
+   * Functions"). v and z are scratch buffers of n and n + 1 elements.
+   */
+  void WorldModel::DistanceTransform(const float *f, int n, float *d, int *v, double *z) {
+    const float kInfinity = std::numeric_limits<float>::infinity();
+    /* Lower envelope of the parabolas rooted at the finite samples */
+    int k = -1;
+    for (int q = 0; q < n; q++) {
+      if (f[q] == kInfinity) {
+        continue;
+      }
+      double s = -std::numeric_limits<double>::infinity();
+      while (k >= 0) {
+        int p = v[k];
+        s = ((f[q] + static_cast<double>(q) * q) - (f[p] + static_cast<double>(p) * p)) / (2.0 * (q - p));
+        if (s > z[k]) {
+          break;
+        }
+        k--;
+      }
+      if (k < 0) {
+        s = -std::numeric_limits<double>::infinity();
+      }
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = std::numeric_limits<double>::infinity();
+    }
+    if (k < 0) {
+      std::fill(d, d + n, kInfinity);
+      return;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+      while (z[k + 1] < q) {
+        k++;
+      }
+      float offset = static_cast<float>(q - v[k]);
+      d[q] = offset * offset + f[v[k]];
+    }
+  }
+
+  /* Exact Euclidean distance transform of the obstacle cells, linear in the number of cells */
+  void WorldModel::ComputeClearance() {
+    std::cout << "Computing obstacle clearance...." << std::endl;
+    const float kInfinity = std::numeric_limits<float>::infinity();
+    std::size_t size = cells_.GetSize();
+    clearance_.Assign(size, kInfinity);
+    float *clearance = clearance_.GetMutableData();
+    const unsigned char *cells = cells_.GetData();
+    int length = std::max(model_width_, model_height_);
+    std::vector<float> f(length);
+    std::vector<float> d(length);
+    std::vector<int> v(length);
+    std::vector<double> z(length + 1);
+    for (int x = 0; x < model_width_; x++) {
+      for (int y = 0; y < model_height_; y++) {
+        f[y] = cells[static_cast<std::size_t>(y) * model_width_ + x] == kObstacle ? 0 : kInfinity;
+      }
+      DistanceTransform(f.data(), model_height_, d.data(), v.data(), z.data());
+      for (int y = 0; y < model_height_; y++) {
+        clearance[static_cast<std::size_t>(y) * model_width_ + x] = d[y];
+      }
+    }
+    for (int y = 0; y < model_height_; y++) {
+      float *row = clearance + static_cast<std::size_t>(y) * model_width_;
+      DistanceTransform(row, model_width_, d.data(), v.data(), z.data());
+      for (int x = 0; x < model_width_; x++) {
+        row[x] = std::sqrt(d[x]);
+      }
+    }
+  }
+
+  float WorldModel::GetClearance(ModelCoordinates coordinates) {
+    return clearance_.Get(Index(coordinates));
+  }
+
+  /* Marks every cell within radius cells of an obstacle as an obstacle. Clearance is left untouched. */
+  void WorldModel::GrowObstacles(double radius) {
+    std::cout << "Growing obstacles by " << radius << " pixels...." << std::endl;
+    Touch();
+    occupancy_.Dilate(radius);
+    unsigned char *cells = cells_.GetMutableData();
+    for (int y = 0; y < model_height_; y++) {
+      const std::uint64_t *words = occupancy_.GetRow(y);
+      for (int j = 0; j < occupancy_.GetWordsPerRow(); j++) {
+        for (std::uint64_t bits = words[j]; bits != 0; bits &= bits - 1) {
+          int x = j * 64 + __builtin_ctzll(bits);
+          unsigned char &cell = cells[static_cast<std::size_t>(y) * model_width_ + x];
+          if (cell == kEmpty) {
+            cell = kObstacle;
+          } else if (cell != kObstacle) {
+            /* Path cells stay as they are */
+            occupancy_.Set(x, y, false);
+          }
+        }
+      }
+    }
+    if (!pyramid_.empty()) {
+      BuildPyramid(GetPyramidLevels());
+    }
+  }
+
+  /*
+   * Lowest clearance of the cells on the segment between the centers of a
+   * and b, visited in the same order as IsLineClear. Infinite if clearance
+   * has not been computed.
+   */
+  float WorldModel::GetLineClearance(ModelCoordinates a, ModelCoordinates b) {
+    if (!clearance_.IsAllocated()) {
+      return std::numeric_limits<float>::infinity();
+    }
+    int x = a.GetX();
+    int y = a.GetY();
+    int nx = std::abs(b.GetX() - x);
+    int ny = std::abs(b.GetY() - y);
+    int sx = b.GetX() > x ? 1 : -1;
+    int sy = b.GetY() > y ? 1 : -1;
+    float lowest = GetClearance(a);
+    for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+      long decision = (1 + 2L * ix) * ny - (1 + 2L * iy) * nx;
+      if (decision <= 0) {
+        x += sx;
+        ix++;
+      }
+      if (decision >= 0) {
+        y += sy;
+        iy++;
+      }
+      lowest = std::min(lowest, GetClearance(ModelCoordinates(x, y)));
+    }
+    return lowest;
+  }
+
+  /* True if no cell from x_min to x_max inclusive on row y is an obstacle */
+  bool WorldModel::IsRowClear(int y, int x_min, int x_max) {
+    return occupancy_.IsRowClear(y, x_min, x_max);
+  }
+
+  /*
+   * True if no cell the segment between the centers of a and b touches is
+   * an obstacle. The cells are visited in order along the segment, a row
+   * run at a time, and the test stops at the first blocked run. Where the
+   * segment passes exactly through a corner it may graze one obstacle cell
+   * beside the corner but not squeeze between two.
+   */
+  bool WorldModel::IsLineClear(ModelCoordinates a, ModelCoordinates b) {
+    int x = a.GetX();
+    int y = a.GetY();
+    int nx = std::abs(b.GetX() - x);
+    int ny = std::abs(b.GetY() - y);
+    int sx = b.GetX() > x ? 1 : -1;
+    int sy = b.GetY() > y ? 1 : -1;
+    int run_start = x;
+    for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+      long decision = (1 + 2L * ix) * ny - (1 + 2L * iy) * nx;
+      if (decision < 0) {
+        x += sx;
+        ix++;
+        continue;
+      }
+      if (!IsRowClear(y, std::min(run_start, x), std::max(run_start, x))) {
+        return false;
+      }
+      if (decision == 0) {
+        if (occupancy_.Get(x + sx, y) && occupancy_.Get(x, y + sy)) {
+          return false;
+        }
+        x += sx;
+        ix++;
+      }
+      y += sy;
+      iy++;
+      run_start = x;
+    }
+    return IsRowClear(y, std::min(run_start, x), std::max(run_start, x));
+  }
+
+  /* Builds levels - 1 coarse levels, each halving the resolution of the one below; level 0 is the model itself */
+  void WorldModel::BuildPyramid(int levels) {
+    pyramid_.assign(std::max(levels - 1, 0), OccupancyBitmap());
+    OccupancyBitmap *finer = &occupancy_;
+    for (OccupancyBitmap &level : pyramid_) {
+      finer->Downsample(&level);
+      finer = &level;
+    }
+  }
+
+  /* Recomputes the coarse cells above a model region so that cleared cells unblock their ancestors */
+  void WorldModel::RefreshPyramid(ModelCoordinates min, ModelCoordinates max) {
+    int x_min = min.GetX();
+    int y_min = min.GetY();
+    int x_max = max.GetX();
+    int y_max = max.GetY();
+    for (int level = 1; level < GetPyramidLevels(); level++) {
+      int finer_width = GetLevelWidth(level - 1);
+      int finer_height = GetLevelHeight(level - 1);
+      x_min >>= 1;
+      y_min >>= 1;
+      x_max >>= 1;
+      y_max >>= 1;
+      for (int y = y_min; y <= y_max; y++) {
+        for (int x = x_min; x <= x_max; x++) {
+          bool blocked = false;
+          for (int fy = 2 * y; fy <= std::min(2 * y + 1, finer_height - 1); fy++) {
+            for (int fx = 2 * x; fx <= std::min(2 * x + 1, finer_width - 1); fx++) {
+              blocked = blocked || IsBlocked(level - 1, fx, fy);
+            }
+          }
+          pyramid_[level - 1].Set(x, y, blocked);
+        }
+      }
+    }
+  }
+
+  int WorldModel::GetPyramidLevels() {
+    return pyramid_.size() + 1;
+  }
+
+  int WorldModel::GetLevelWidth(int level) {
+    return level == 0 ? model_width_ : pyramid_[level - 1].GetWidth();
+  }
+
+  int WorldModel::GetLevelHeight(int level) {
+    return level == 0 ? model_height_ : pyramid_[level - 1].GetHeight();
   }
 
-  void WorldModel::SetValue(ModelCoordinates coordinates, int value) {
-    grid_map_[coordinates.GetY()][coordinates.GetX()] = value;
+  /* True if cell (x, y) of the given level is, or covers, an obstacle */
+  bool WorldModel::IsBlocked(int level, int x, int y) {
+    return level == 0 ? occupancy_.Get(x, y) : pyramid_[level - 1].Get(x, y);
   }
 
   std::deque<ModelCoordinates> WorldModel::GetNeighbors(ModelCoordinates coordinates) {
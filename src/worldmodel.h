@@ -26,10 +26,16 @@
 #ifndef WORLDMODEL_H
 #define WORLDMODEL_H
 
-#include <climits>
+#include <atomic>
+#include <cstddef>
 #include <deque>
+#include <memory>
 #include <string>
+#include <vector>
+#include "gridlayer.h"
+#include "mappedfile.h"
 #include "misc.h"
+#include "occupancybitmap.h"
 
 namespace jlbot {
 
@@ -45,18 +51,32 @@ namespace jlbot {
     int y_;
   };
 
+  /*
+   * Occupancy grid sized to the map at load time. Cell states live in a
+   * one byte layer; wavefront distances are kept by the planners' own
+   * WavefrontEngine, not here. The clearance layer holds the exact
+   * Euclidean distance, in cells, from each cell to the nearest obstacle.
+   * Cell and clearance layers may borrow pages from a map cache, so copies
+   * of a cached model are cheap until written. A bit-packed copy of the
+   * obstacle cells is kept in sync for bulk queries, and an optional pyramid
+   * of coarser copies marks a coarse cell blocked if any cell under it is.
+   */
   class WorldModel {
   public:
-    static const int kEmpty = INT_MIN;
-    static const int kObstacle = INT_MIN + 1;
-    static const int kPath = INT_MIN + 2;
+    static const unsigned char kEmpty = 0;
+    static const unsigned char kObstacle = 1;
+    static const unsigned char kPath = 2;
+    static const int kScaleMap = 2;
+    WorldModel();
     WorldModel(std::string filename);
     ModelCoordinates WorldToModel(WorldCoordinates world);
     WorldCoordinates ModelToWorld(ModelCoordinates model);
-    int GetValue(ModelCoordinates coordinates);
-    void SetValue(ModelCoordinates coordinates, int value);
+    unsigned char GetValue(ModelCoordinates coordinates);
+    void SetValue(ModelCoordinates coordinates, unsigned char value);
     std::deque<ModelCoordinates> GetNeighbors(ModelCoordinates coordinates);
     void Save(std::string filename);
+    static std::string EncodePnm(const unsigned char *cells, int width, int height);
+    static std::size_t ReadPnmHeader(const unsigned char *data, std::size_t size, int *width, int *height);
     int GetHeight();
     int GetWidth();
     bool IsEmpty(ModelCoordinates coordinates);
@@ -65,21 +85,41 @@ namespace jlbot {
     void SetEmpty(ModelCoordinates coordinates);
     void SetObstacle(ModelCoordinates coordinates);
     void SetPath(ModelCoordinates coordinates);
+    void ComputeClearance();
+    float GetClearance(ModelCoordinates coordinates);
+    void GrowObstacles(double radius);
+    bool IsRowClear(int y, int x_min, int x_max);
+    bool IsLineClear(ModelCoordinates a, ModelCoordinates b);
+    float GetLineClearance(ModelCoordinates a, ModelCoordinates b);
+    void BuildPyramid(int levels);
+    int GetPyramidLevels();
+    int GetLevelWidth(int level);
+    int GetLevelHeight(int level);
+    bool IsBlocked(int level, int x, int y);
+    void RefreshPyramid(ModelCoordinates min, ModelCoordinates max);
+    unsigned long GetRevision();
+    const unsigned char *GetCells();
+    const float *GetClearances();
+    void BorrowCells(int width, int height, const unsigned char *cells, std::shared_ptr<MappedFile> backing);
+    void BorrowClearances(const float *clearances, std::shared_ptr<MappedFile> backing);
   private:
-    static const int kScaleMap = 2;
-    static const int kGridRows = 1000;
-    static const int kGridCols = 1000;
-    const double kWorldWidth = 40;
-    const double kWorldHeight = 18;
-    char pnm_first_line_[80];
-    int pnm_width_;
-    int pnm_height_;
-    int pnm_max_val_;
+    static constexpr double kWorldWidth = 40;
+    static constexpr double kWorldHeight = 18;
+    static std::atomic<unsigned long> last_revision_;
     int model_height_;
     int model_width_;
-    int grid_map_[kGridRows][kGridCols];
-    void Empty();
+    unsigned long revision_;
+    GridLayer<unsigned char> cells_;
+    GridLayer<float> clearance_;
+    OccupancyBitmap occupancy_;
+    std::vector<OccupancyBitmap> pyramid_;
+    std::size_t Index(ModelCoordinates coordinates);
     void ReadMap(std::string filename);
+    void BuildOccupancy();
+    void Touch();
+    static void PoolRows(const unsigned char *rows, std::size_t stride, int width, unsigned char *pooled);
+    static void PoolColumns(const unsigned char *pooled, int count, unsigned char *cells);
+    static void DistanceTransform(const float *f, int n, float *d, int *v, double *z);
   };
 } // namespace jlbot
 #endif /* WORLDMODEL_H */
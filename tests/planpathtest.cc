@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017 Johnathan Louie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+
+/*
+ * File:   planpathtest.cc
+ * Author: Johnathan Louie
+ *
+ * Created on October 17, 2026, 8:10 PM
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "planners.h"
+
+/*
+ * Plans with every planner on the hospital map, from the resources
+ * directory. Starts and goals off the map must be refused as unreachable
+ * rather than handed to the planners, and a goal on the map still found.
+ */
+int main() {
+  const char *planners[] = {"wavefront", "astar", "bidirectional", "dstarlite", "jps", "thetastar", "clearance"};
+  jlbot::WorldCoordinates start(-14, 3.6);
+  int failures = 0;
+  for (const char *planner : planners) {
+    jlbot::Navigator navigator(NULL, planner);
+    struct {
+      jlbot::WorldCoordinates start;
+      jlbot::WorldCoordinates goal;
+      bool expected;
+    } cases[] = {
+      {start, jlbot::WorldCoordinates(0, 20), false},
+      {start, jlbot::WorldCoordinates(30, 0), false},
+      {jlbot::WorldCoordinates(-30, 0), jlbot::WorldCoordinates(8.5, -4), false},
+      {start, jlbot::WorldCoordinates(8.5, -4), true},
+    };
+    for (auto &test : cases) {
+      if (navigator.PlanPath(test.start, test.goal) != test.expected) {
+        std::cerr << planner << ": planning from " << test.start.ToString() << " to " << test.goal.ToString() << " should " << (test.expected ? "succeed" : "fail") << "." << std::endl;
+        failures++;
+      }
+    }
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}